@@ -1,22 +1,35 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <stop_token>
+#include <new>
+#include <span>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-#ifndef JOBSYS_TELEMETRY
-    #define JOBSYS_TELEMETRY 0
-#endif
+#include "JobSystemPolicies.h"
+#include "Labels.h"
+#include "ScheduleTrace.h"
+#include "ThreadPool.h"
 
 namespace core
 {
-    class JobSystem
+    // The policy-independent part of a JobSystem: its public types, the pool it runs on and
+    // the help-or-park machinery Sync.h builds on. The pool drives front-ends through it.
+    class JobSystemBase
     {
     public:
         enum class StopMode : uint8_t
@@ -25,23 +38,99 @@ namespace core
             CancelPending // drop queued work, finish only in-flight
         };
 
-        struct Config
+        enum class CoreHint : uint8_t
         {
-            uint32_t workerThreads = 0; // 0 = hardware_concurrency (fallback to 1)
+            Any,
+            HighCapacity // prefer workers on the biggest cores (see ThreadPool::Config::pinWorkers)
+        };
+
+        enum class Priority : uint8_t
+        {
+            Normal,
+            Realtime // served first, and by the pool's realtime workers (see ThreadPool::Config::realtimeWorkers)
+        };
+
+        // Non-owning reference to a submitted job: its task slot plus the slot's generation at
+        // submission. The generation moves on when the job finishes, so a handle stays safe to
+        // query after its slot is reused. A default handle refers to no job.
+        struct JobHandle
+        {
+            uint32_t index = 0;
+            uint32_t generation = 0; // 0 = invalid
+
+            explicit operator bool() const { return generation != 0; }
+        };
+
+        struct SubmitOptions
+        {
+            Label label; // name or JOBKIT_LABEL; ignored without telemetry
+            CoreHint cores = CoreHint::Any;
+            Priority priority = Priority::Normal;
+
+            // Jobs of this JobSystem that must finish first. Finished and invalid handles are
+            // ignored. The span is only read during Submit.
+            std::span<const JobHandle> dependsOn;
+        };
+
+        struct ParallelForOptions
+        {
+            // Chunk boundaries fall on multiples of this many elements; only the last chunk may
+            // be shorter. Use CacheLineElements<T>() to keep chunks off each other's cache lines
+            // (given a 64-byte aligned array), or the SIMD width of the kernel.
+            size_t alignment = 1;
+            size_t grainSize = 0; // elements per chunk before rounding; 0 = ~4 chunks per worker
+            Label label;
+        };
+
+        template <typename T>
+        static constexpr size_t CacheLineElements()
+        {
+            return sizeof(T) >= 64 ? 1 : 64 / sizeof(T);
+        }
+
+        // Runtime telemetry switches (FullTelemetry). Off, jobs skip all bookkeeping but
+        // schedule recording. sampleEvery = N times one job in N per thread: busy time (scaled
+        // by N), job ids, label histograms, queue ages and job start times are then drawn from
+        // samples.
+        // Starts on when built with JOBSYS_TELEMETRY.
+        struct TelemetrySettings
+        {
+            bool enabled = JOBSYS_TELEMETRY != 0;
+            uint32_t sampleEvery = 1;
+        };
+
+        // Thread settings (workerThreads, ...) are inherited from ThreadPool::Config and used
+        // to build a private pool unless an existing pool is supplied.
+        struct Config : ThreadPool::Config
+        {
+            // Shared worker pool. Several JobSystems may attach to one pool; each keeps its own
+            // queue, stats, WaitIdle and Stop. Null = spawn a private pool.
+            std::shared_ptr<ThreadPool> pool;
+
+            // Jobs run by a thread helping in Wait or WaitIdle nest on its stack. Beyond this
+            // many levels the thread blocks instead of helping, which bounds stack use; keep it
+            // above the deepest fork-join recursion, since a blocked helper runs nothing.
+            uint32_t maxHelpDepth = 256;
+
+            TelemetrySettings telemetry{};
         };
 
         struct Stats
         {
             uint32_t workerCount = 0;
+            uint32_t startedWorkers = 0; // < workerCount while a lazyStart pool is still growing
+            uint32_t realtimeWorkersApplied = 0; // realtime workers the OS actually promoted
+            bool paused = false;
 
             uint64_t queued = 0;
+            uint64_t waiting = 0; // held back by unfinished dependencies
             uint64_t inFlight = 0;
 
             uint64_t submitted = 0;
             uint64_t completed = 0;
         };
 
-#if JOBSYS_TELEMETRY
+        // FullTelemetry only (TelemetryPolicy).
         struct Diagnostics
         {
             struct Worker
@@ -50,8 +139,24 @@ namespace core
                 std::thread::id osThreadId{};
                 bool running = false;
 
-                uint64_t runningTaskId = 0;
+                uint64_t runningTaskId = 0; // 0 = none, or its submission was not sampled
                 const char* runningLabel = nullptr;
+                LabelId runningLabelId = LabelRegistry::kNone;
+                int64_t runningSinceNs = 0; // steady_clock time the running job started; 0 = not sampled
+
+                // Cumulative. Busy time (outermost jobs only, helped jobs inside them included),
+                // jobs run and steals are for this system's jobs and queues; a failed steal is a
+                // pass over the victims that found nothing. Spin, parked time and wakeups belong to
+                // the pool worker and are shared with every JobSystem attached to it. Busy time is
+                // estimated from samples when sampling.
+                uint64_t busyNs = 0;
+                uint64_t jobsExecuted = 0;
+                uint64_t steals = 0;
+                uint64_t failedSteals = 0;
+                uint64_t spinNs = 0;
+                uint64_t parkedNs = 0;
+                uint64_t wakeups = 0;
+                uint64_t spuriousWakeups = 0;
             };
 
             Stats stats;
@@ -62,76 +167,646 @@ namespace core
             {
                 uint64_t id = 0;
                 const char* label = nullptr;
+                LabelId labelId = LabelRegistry::kNone;
             };
             std::vector<QueuedTask> queuedTasks;
         };
-#endif
 
-    public:
-        explicit JobSystem(const Config& cfg = {});
-        ~JobSystem();
+        // Ready jobs and how long they have been queued (since submit, or since their last
+        // dependency finished). Ages cover sampled jobs only.
+        struct QueueAges
+        {
+            uint64_t ready = 0;
+            uint64_t olderThan = 0; // queued longer than the threshold asked for
+            int64_t oldestNs = 0;
+        };
+
+        // Run-time distribution of one label's jobs, summed over the pool's workers. Times are
+        // own time, without time spent in waits (see ScheduleRecord). buckets[i] counts runs of
+        // at most kLabelHistogramBoundsNs[i]; the last bucket counts the rest.
+        static constexpr size_t kLabelHistogramBuckets = 8;
+        static constexpr int64_t kLabelHistogramBoundsNs[kLabelHistogramBuckets - 1] = {
+            1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, 1'000'000'000};
+
+        struct LabelHistogram
+        {
+            std::string label;
+            LabelId labelId = LabelRegistry::kNone;
+            uint64_t buckets[kLabelHistogramBuckets] = {};
+            uint64_t count = 0;
+            uint64_t sumNs = 0;
+        };
+
+        JobSystemBase(const JobSystemBase&) = delete;
+        JobSystemBase& operator=(const JobSystemBase&) = delete;
+
+        // The worker pool this system runs on (private or shared).
+        const ThreadPool& Pool() const { return *m_pool; }
+
+        // Read side of the stats and telemetry, for tools that take any configuration
+        // (StallWatchdog, the metrics exporter). See JobSystemT; with NoTelemetry the telemetry
+        // reads report it off and return nothing.
+        virtual Stats GetStats() const = 0;
+        virtual TelemetrySettings GetTelemetry() const = 0;
+        virtual std::vector<Diagnostics::Worker> GetWorkerDiagnostics() const = 0;
+        virtual std::vector<LabelHistogram> GetLabelHistograms() const = 0;
+        virtual QueueAges GetQueueAges(int64_t thresholdNs) const = 0;
+
+        // Building blocks for scheduler-aware waits (see Sync.h). HelpOne runs one queued job on
+        // the calling thread, if any and if maxHelpDepth allows. HelpUntil runs jobs until
+        // ready() holds and parks on a futex while there is nothing to run. Whoever makes
+        // ready() true must call WakeHelpers() afterwards; it costs one load when none is parked.
+        // ready() should read its state with seq_cst loads.
+        virtual bool HelpOne() = 0;
+
+        template <typename Ready>
+        void HelpUntil(Ready&& ready);
+
+        void WakeHelpers();
 
-        JobSystem(const JobSystem&) = delete;
-        JobSystem& operator=(const JobSystem&) = delete;
+    protected:
+        // Builds a private pool unless cfg supplies one. idleSpins: see IdlePolicy.
+        JobSystemBase(const Config& cfg, uint32_t idleSpins);
+        ~JobSystemBase() = default;
 
-        // Returns false if the system is stopping or stopped.
-        bool Submit(std::function<void()> task);
+        bool CanHelp() const; // within maxHelpDepth on this thread
 
-        // Telemetry-friendly submission. Label is ignored if JOBSYS_TELEMETRY == 0.
-        bool SubmitLabeled(const char* label, std::function<void()> task);
+        // Yields up to m_idleSpins times until ready() holds; false if it never did.
+        template <typename Ready>
+        bool SpinUntil(Ready&& ready) const;
 
+        friend class ThreadPool;
+
+        // Called by pool workers. A successful dequeue counts the task in flight, which keeps
+        // the front-end attached until PoolRun completes it. The task is opaque to the pool.
+        // nearOnly limits stealing to the worker's near victims (ThreadPool::StealOrder).
+        virtual bool PoolDequeue(uint32_t workerIndex, bool nearOnly, void*& task) = 0;
+        virtual void PoolRun(uint32_t workerIndex, void* task) = 0;
+        virtual bool HasQueuedWork() const = 0;
+
+        Config m_cfg{};
+        std::shared_ptr<ThreadPool> m_pool;
+        bool m_ownsPool = false;
+        const uint32_t m_idleSpins;
+
+        std::atomic<uint32_t> m_parked{0};    // threads asleep in HelpUntil
+        std::atomic<uint32_t> m_parkEpoch{0}; // bumped by WakeHelpers
+    };
+
+    namespace detail
+    {
+        inline int64_t NowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Timed jobs on this thread's stack, and the time the innermost one was not running its
+        // own code: jobs nested in it while it helped, and waits. That time is not its own.
+        inline thread_local uint32_t t_timedDepth = 0;
+        inline thread_local int64_t t_nestedNs = 0;
+
+        // Scope of a wait inside a timed job: its whole length, helped jobs included, is taken
+        // out of the job's time. Whether the awaited job ran here or on another worker then
+        // makes no difference to the waiting job's recorded time.
+        class WaitTimer
+        {
+        public:
+            WaitTimer()
+                : m_startNs(t_timedDepth != 0 ? NowNs() : 0)
+                , m_outerNestedNs(t_nestedNs)
+            {
+            }
+
+            ~WaitTimer()
+            {
+                if (m_startNs != 0)
+                    t_nestedNs = m_outerNestedNs + (NowNs() - m_startNs);
+            }
+
+            WaitTimer(const WaitTimer&) = delete;
+            WaitTimer& operator=(const WaitTimer&) = delete;
+
+        private:
+            const int64_t m_startNs;
+            const int64_t m_outerNestedNs;
+        };
+
+        // Telemetry of a sampled or recorded job. Kept in the slab beside the tasks, not in
+        // their cache line: other jobs never touch it.
+        struct TaskTrace
+        {
+            uint64_t id;
+            uint64_t parentId;
+            int64_t submitNs; // 0 = not recorded
+            int64_t readyNs;  // queued since
+            uint32_t epoch;
+        };
+
+        template <bool Enabled, uint32_t N>
+        struct SlabTraces
+        {
+        };
+
+        template <uint32_t N>
+        struct SlabTraces<true, N>
+        {
+            TaskTrace items[N];
+        };
+    } // namespace detail
+
+    // A job queue on a ThreadPool, specialized at compile time by the policies in
+    // JobSystemPolicies.h. core::JobSystem is the default configuration and is compiled into
+    // the library; other configurations must include JobSystemImpl.h where they are used.
+    template <typename QueuePolicy = WorkStealingQueues, typename IdlePolicy = ParkWhenIdle,
+              typename TelemetryPolicy = DefaultTelemetry, typename TaskStorage = DefaultTaskStorage>
+    class JobSystemT final : public JobSystemBase
+    {
+        static constexpr bool kTelemetry = TelemetryPolicy::kEnabled;
+        static constexpr bool kLocalQueues = QueuePolicy::kLocalQueues;
+
+    public:
+        JobSystemT();
+        explicit JobSystemT(const Config& cfg);
+        ~JobSystemT();
+
+        // Returns an invalid handle if the system is stopping or stopped, the callable is empty
+        // or the slab is full (kMaxLiveJobs). The callable is constructed directly in its task
+        // slot and runs from there; captures up to kInlineTaskBytes are stored inline, larger
+        // ones on the heap.
+        template <typename F>
+        JobHandle Submit(F&& task);
+
+        // Telemetry-friendly submission. Label is ignored without telemetry.
+        template <typename F>
+        JobHandle SubmitLabeled(Label label, F&& task);
+
+        template <typename F>
+        JobHandle Submit(const SubmitOptions& opts, F&& task);
+
+        // True once the job has finished running or was cancelled. Lock-free.
+        bool IsDone(JobHandle job) const;
+
+        // Blocks until IsDone(job), running other queued jobs of this system meanwhile. Safe to
+        // call from inside a job.
+        void Wait(JobHandle job);
+
+        bool HelpOne() override;
+
+        // Calls body(begin, end) for aligned chunks covering [0, count) and returns once all
+        // have run. The calling thread runs the first chunk and helps with the rest, so this is
+        // safe from inside a job. Runs everything inline if the system is stopped. If body
+        // throws, chunks not yet started are skipped and the first exception is rethrown once
+        // the running ones finish.
+        template <typename F>
+        void ParallelFor(size_t count, const ParallelForOptions& opts, F&& body);
+
+        template <typename F>
+        void ParallelFor(size_t count, F&& body)
+        {
+            ParallelFor(count, ParallelForOptions{}, std::forward<F>(body));
+        }
+
+        // Blocks until no job of this system is queued, waiting or running. From inside one of
+        // its jobs it runs queued jobs meanwhile and returns once the only jobs left are those
+        // likewise blocked in WaitIdle, so nested fork-join regions never deadlock.
         void WaitIdle();
 
         void Stop(StopMode mode = StopMode::Drain);
 
-        Stats GetStats() const;
-
-#if JOBSYS_TELEMETRY
-        Diagnostics GetDiagnostics() const;
-#endif
+        // Pause stops workers from picking up this system's jobs; Submit keeps queuing without
+        // waking them. Returns once in-flight jobs have finished (immediately when called from
+        // one of them), leaving the worker threads parked. In-flight jobs blocked in Wait,
+        // ParallelFor or WaitIdle keep running queued jobs meanwhile, as what they wait on may
+        // be among them. Resume wakes the workers. Stop resumes implicitly. WaitIdle from
+        // outside blocks while paused work is queued.
+        void Pause();
+        void Resume();
+
+        // Lock-free; fields are read one by one, so a snapshot taken under load may be
+        // slightly inconsistent (e.g. a job counted neither queued nor in flight).
+        Stats GetStats() const override;
+
+        Diagnostics GetDiagnostics() const requires TelemetryPolicy::kEnabled;
+
+        // The lock-free parts of GetDiagnostics, for exporters that poll while jobs run.
+        // Histograms cover labelled jobs run by pool workers, sorted by label. Empty with
+        // NoTelemetry.
+        std::vector<Diagnostics::Worker> GetWorkerDiagnostics() const override;
+        std::vector<LabelHistogram> GetLabelHistograms() const override;
+
+        // Scans the ready queues under the scheduler lock; meant for low-rate sampling.
+        QueueAges GetQueueAges(int64_t thresholdNs) const override;
+
+        // Schedule recording. Every job submitted between Start and Stop is captured with its
+        // label, submitting job, WaitIdle epoch, submit time and measured run time.
+        // StartRecording returns false if a recording is already active or the system is stopped.
+        bool StartRecording() requires TelemetryPolicy::kEnabled;
+        ScheduleTrace StopRecording() requires TelemetryPolicy::kEnabled;
+
+        // Runtime telemetry control, see TelemetrySettings. CaptureDetailed samples every job for
+        // the given time, e.g. while investigating an incident, then returns to the set rate.
+        // SetTelemetry ends a capture still running.
+        void SetTelemetry(const TelemetrySettings& settings) requires TelemetryPolicy::kEnabled;
+        TelemetrySettings GetTelemetry() const override; // off with NoTelemetry
+        void CaptureDetailed(std::chrono::nanoseconds duration) requires TelemetryPolicy::kEnabled;
 
     private:
-        struct TaskItem
+        // One cache line: the callable inline, its invoker and packed metadata. Items live in
+        // a slab and the queues hold slot indices, so a job is constructed in place on Submit
+        // and runs from the same slot. Telemetry lives beside it (SlotLinks, SlabTraces).
+        struct alignas(64) TaskItem
         {
-            std::function<void()> fn;
+            static constexpr size_t kInlineBytes = TaskStorage::kInlineBytes;
+            static constexpr size_t kInlineAlign = 16;
+
+            // Runs the callable when run is set, then destroys it (also when it throws).
+            using InvokeFn = void (*)(TaskItem& self, bool run);
 
-#if JOBSYS_TELEMETRY
+            alignas(kInlineAlign) unsigned char payload[kInlineBytes];
+            InvokeFn invoke;
+            uint32_t slot;                          // own index in the slab
+            std::atomic<uint32_t> generation{1};    // bumped when the job finishes; never 0
+
+            template <typename F>
+            void Emplace(F&& fn);
+        };
+        static_assert(TaskStorage::kInlineBytes != 48 || sizeof(TaskItem) == 64,
+                      "TaskItem must stay cache-line sized");
+
+        // Per-slot bookkeeping kept off the task's cache line; RetireSlot reads it for every
+        // job anyway. The dependency fields are guarded by m_mtx. The rest is set by Enqueue
+        // and read-only while the job lives.
+        struct SlotLinks
+        {
+            uint32_t pendingDeps = 0;               // > 0 while the job waits
+            uint32_t firstDependent = 0;            // head of the edge list (kNoEdge = none)
+            uint8_t lane = 0;
+            bool traced = false;                    // has a TaskTrace (sampled or recorded)
+            LabelId labelId = LabelRegistry::kNone; // with telemetry on
+        };
+
+        // Jobs waiting on a slot, as a free-listed singly linked list.
+        struct DependentEdge
+        {
+            uint32_t slot = 0;
+            uint32_t next = 0;
+        };
+
+        static constexpr uint32_t kSlabChunkShift = 8;
+        static constexpr uint32_t kSlabChunkSize = 1u << kSlabChunkShift;
+        static constexpr uint32_t kMaxSlabChunks = 4096;
+        static constexpr uint32_t kNoEdge = UINT32_MAX;
+
+        struct SlabChunk
+        {
+            TaskItem items[kSlabChunkSize];
+            SlotLinks links[kSlabChunkSize];
+            detail::SlabTraces<TelemetryPolicy::kEnabled, kSlabChunkSize> traces;
+        };
+
+    public:
+        static constexpr size_t kInlineTaskBytes = TaskItem::kInlineBytes;
+        static constexpr uint32_t kMaxLiveJobs = kSlabChunkSize * kMaxSlabChunks;
+
+    private:
+        struct RecordedJob
+        {
             uint64_t id = 0;
-            const char* label = nullptr;
-#endif
+            uint64_t parentId = 0;
+            LabelId labelId = LabelRegistry::kNone;
+            uint32_t epoch = 0;
+            uint32_t worker = 0;
+            int64_t submitNs = 0;
+            int64_t startNs = 0;
+            int64_t endNs = 0;
+            int64_t nestedNs = 0; // spent in waits, other jobs run meanwhile included
         };
 
-        void WorkerLoop(std::stop_token st, uint32_t workerIndex);
+        void RecordJob(uint32_t workerIndex, const detail::TaskTrace& trace, LabelId label, int64_t startNs,
+                       int64_t endNs, int64_t nestedNs) requires TelemetryPolicy::kEnabled;
+
+        // (job, dependency) ids captured by Submit while recording. Guarded by m_mtx.
+        std::vector<std::pair<uint64_t, uint64_t>> m_recordedDeps;
+
+        // Takes a free slot, lets construct() build the callable in it and queues it.
+        using ConstructFn = void (*)(TaskItem& item, void* ctx);
+        JobHandle Enqueue(const SubmitOptions& opts, ConstructFn construct, void* ctx);
+
+        // Slab access. Chunks are published once and never move, so any thread may look up a
+        // slot it got from a queue or a handle; everything but the generation needs m_mtx, or
+        // the local queue's lock while the job sits in one.
+        SlabChunk& Chunk(uint32_t index) const { return *m_slab[index >> kSlabChunkShift].load(std::memory_order_acquire); }
+        TaskItem& Slot(uint32_t index) const { return Chunk(index).items[index & (kSlabChunkSize - 1)]; }
+        SlotLinks& Links(uint32_t index) const { return Chunk(index).links[index & (kSlabChunkSize - 1)]; }
+        detail::TaskTrace& Trace(uint32_t index) const requires TelemetryPolicy::kEnabled
+        {
+            return Chunk(index).traces.items[index & (kSlabChunkSize - 1)];
+        }
+        uint64_t TaskId(uint32_t index) const; // 0 unless traced
+        bool AllocateSlot(uint32_t& out); // false when kMaxLiveJobs are live
+
+        // m_mtx held. Ends the job's generation and releases dependents whose last dependency
+        // it was; returns how many were queued and whether any is Priority::Realtime.
+        uint32_t RetireSlot(uint32_t slot, bool& realtimeReleased);
+
+        // A successful dequeue counts the task in flight, which keeps this front-end attached
+        // until RunTask completes it and frees its slot. Waiting threads take the newest shared
+        // job instead: usually the waited-on child, which keeps nesting shallow. A worker's own
+        // local queue is always newest first.
+        bool TryDequeue(uint32_t workerIndex, TaskItem*& out, bool newest = false, bool nearOnly = false);
+        bool TakeFrom(std::deque<uint32_t>& q, bool back, TaskItem*& out); // shared lane, m_mtx held
+        bool TakeLocal(uint32_t worker, bool back, TaskItem*& out);         // m_mtx not held
+        TaskItem* PopSlot(std::deque<uint32_t>& q, bool back);              // q's lock held
+        void RunTask(uint32_t workerIndex, TaskItem& task);
+
+        // Paused, and not called from inside one of our jobs (see Pause).
+        bool HeldByPause() const;
+
+        bool PoolDequeue(uint32_t workerIndex, bool nearOnly, void*& task) override;
+        void PoolRun(uint32_t workerIndex, void* task) override;
+        bool HasQueuedWork() const override;
+
+        // WaitIdle called from inside one of this system's jobs.
+        void HelpUntilIdle();
 
     private:
-        Config m_cfg{};
+        std::atomic<uint32_t> m_workerCount{0};
 
         mutable std::mutex m_mtx;
-        std::condition_variable m_cvWork;
         std::condition_variable m_cvIdle;
 
-        std::deque<TaskItem> m_queue;
+        static constexpr uint32_t kLaneRealtime = 0;
+        static constexpr uint32_t kLaneHighCapacity = 1;
+        static constexpr uint32_t kLaneAny = 2;
+        static constexpr uint32_t kLaneCount = 3;
+
+        // A worker's own jobs, with a lock of their own: the owner and thieves take from them
+        // without m_mtx. Pushed under both locks (m_mtx first).
+        struct alignas(64) LocalQueue
+        {
+            mutable std::mutex mtx;
+            std::deque<uint32_t> slots;
+        };
+
+        std::deque<uint32_t> m_queues[kLaneCount];   // slab slots
+        std::unique_ptr<LocalQueue[]> m_local;       // per worker: kLaneAny jobs it submitted (kLocalQueues)
+        uint32_t m_localCount = 0;
+        std::atomic<uint64_t> m_queuedCount{0};      // across all lanes and local queues
+        std::atomic<uint64_t> m_sharedQueued{0};     // in m_queues; written under m_mtx
+        std::atomic<uint64_t> m_waitingCount{0};     // written under m_mtx, read lock-free by GetStats
+        uint64_t m_readiedCount = 0;                 // jobs ever queued ready; guarded by m_mtx
+
+        std::atomic<uint32_t> m_handleWaiters{0}; // threads blocked in Wait
+        uint32_t m_idleHelpers = 0;               // jobs blocked in WaitIdle
+
+        std::unique_ptr<std::atomic<SlabChunk*>[]> m_slab; // kMaxSlabChunks entries
+        uint32_t m_slabChunks = 0;
+        std::vector<uint32_t> m_freeSlots;
+        std::vector<DependentEdge> m_edges;
+        uint32_t m_freeEdge = kNoEdge;
 
         std::atomic<bool> m_accepting{true};
+        std::atomic<bool> m_paused{false};
 
         std::atomic<uint64_t> m_inFlight{0};
         std::atomic<uint64_t> m_submitted{0};
         std::atomic<uint64_t> m_completed{0};
 
-        std::vector<std::jthread> m_workers;
-
-#if JOBSYS_TELEMETRY
+        // Telemetry state; left empty without it.
         std::atomic<uint64_t> m_nextTaskId{1};
+        std::atomic<uint32_t> m_epoch{0};
 
         struct alignas(64) WorkerTelemetry
         {
-            std::thread::id osThreadId{};
+            std::atomic<std::thread::id> osThreadId{};
             std::atomic<uint64_t> runningTaskId{0};
-            std::atomic<const char*> runningLabel{nullptr};
+            std::atomic<LabelId> runningLabelId{LabelRegistry::kNone};
+            std::atomic<int64_t> runningSinceNs{0};
             std::atomic<bool> running{false};
+
+            // Written only by the owning worker (plain load + store).
+            std::atomic<uint64_t> busyNs{0};
+            std::atomic<uint64_t> jobsExecuted{0};
+            std::atomic<uint64_t> steals{0};
+            std::atomic<uint64_t> failedSteals{0};
+            uint32_t sampleTick = 0;
+
+            // Per-label run times indexed by label id, in chunks the owner allocates on first
+            // use and publishes zeroed; readers skip chunks not yet published.
+            struct LabelSlot
+            {
+                std::atomic<uint64_t> buckets[kLabelHistogramBuckets]{};
+                std::atomic<uint64_t> count{0};
+                std::atomic<uint64_t> sumNs{0};
+            };
+            static constexpr uint32_t kLabelChunk = 64;
+            std::atomic<LabelSlot*> labelChunks[LabelRegistry::kMaxLabels / kLabelChunk]{};
+
+            WorkerTelemetry() = default;
+            ~WorkerTelemetry()
+            {
+                for (std::atomic<LabelSlot*>& chunk : labelChunks)
+                    delete[] chunk.load(std::memory_order_relaxed);
+            }
+
+            // Owner appends while recording; StopRecording drains.
+            std::mutex recordMtx;
+            std::vector<RecordedJob> recorded;
         };
-        std::vector<WorkerTelemetry> m_workerTel;
-#endif
+        static void RecordLabelTime(WorkerTelemetry& tel, LabelId label, int64_t ns); // owner only
+
+        // Set up by the constructor and read lock-free (exporters, watchdogs) until the
+        // destructor, also across Stop.
+        std::unique_ptr<WorkerTelemetry[]> m_workerTel;
+        uint32_t m_workerTelCount = 0;
+
+        std::atomic<bool> m_recording{false};
+        std::atomic<int64_t> m_recordOriginNs{0};
+
+        // Read on every job; m_sampleEvery is 1 during a detailed capture.
+        std::atomic<bool> m_telemetryOn{true};
+        std::atomic<uint32_t> m_sampleEvery{1};
+        std::atomic<int64_t> m_detailedUntilNs{0}; // 0 = no detailed capture
+
+        mutable std::mutex m_telemetryMtx; // guards setting changes
+        TelemetrySettings m_telemetry{};   // as set, without the capture
+        bool m_poolCounters = false;       // holds a ThreadPool::RetainCounters reference
+
+        void EndDetailedCapture(int64_t nowNs) requires TelemetryPolicy::kEnabled;
+
+        // Keeps the pool's worker counters while telemetry is on. m_telemetryMtx held.
+        void UpdatePoolCounters() requires TelemetryPolicy::kEnabled;
     };
-} // namespace core
 
+    using JobSystem = JobSystemT<>;
+    extern template class JobSystemT<>;
+
+    template <typename Q, typename I, typename T, typename S>
+    template <typename F>
+    void JobSystemT<Q, I, T, S>::TaskItem::Emplace(F&& fn)
+    {
+        using Fn = std::decay_t<F>;
+
+        if constexpr (sizeof(Fn) <= kInlineBytes && alignof(Fn) <= kInlineAlign)
+        {
+            ::new (static_cast<void*>(payload)) Fn(std::forward<F>(fn));
+            invoke = [](TaskItem& self, bool run) {
+                Fn& f = *std::launder(reinterpret_cast<Fn*>(self.payload));
+                if (run)
+                {
+                    try
+                    {
+                        f();
+                    }
+                    catch (...)
+                    {
+                        f.~Fn();
+                        throw;
+                    }
+                }
+                f.~Fn();
+            };
+        }
+        else
+        {
+            Fn* heap = new Fn(std::forward<F>(fn));
+            std::memcpy(payload, &heap, sizeof(heap));
+            invoke = [](TaskItem& self, bool run) {
+                Fn* f = nullptr;
+                std::memcpy(&f, self.payload, sizeof(f));
+                std::unique_ptr<Fn> owner(f);
+                if (run)
+                    (*f)();
+            };
+        }
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    template <typename F>
+    JobSystemBase::JobHandle JobSystemT<Q, I, T, S>::Submit(F&& task)
+    {
+        return Submit(SubmitOptions{}, std::forward<F>(task));
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    template <typename F>
+    JobSystemBase::JobHandle JobSystemT<Q, I, T, S>::SubmitLabeled(Label label, F&& task)
+    {
+        SubmitOptions opts{};
+        opts.label = label;
+        return Submit(opts, std::forward<F>(task));
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    template <typename F>
+    JobSystemBase::JobHandle JobSystemT<Q, I, T, S>::Submit(const SubmitOptions& opts, F&& task)
+    {
+        using Fn = std::decay_t<F>;
+        static_assert(std::is_invocable_v<Fn&>, "a job is a callable taking no arguments");
+
+        // Empty std::function or null function pointer.
+        if constexpr (std::is_constructible_v<bool, const Fn&>)
+        {
+            if (!static_cast<bool>(task))
+                return JobHandle{};
+        }
+
+        using Ref = std::remove_reference_t<F>;
+        return Enqueue(opts, [](TaskItem& item, void* ctx) {
+            item.Emplace(std::forward<F>(*static_cast<Ref*>(ctx)));
+        }, const_cast<void*>(static_cast<const void*>(std::addressof(task))));
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    template <typename F>
+    void JobSystemT<Q, I, T, S>::ParallelFor(size_t count, const ParallelForOptions& opts, F&& body)
+    {
+        if (count == 0)
+            return;
+
+        const size_t align = std::max<size_t>(opts.alignment, 1);
+        size_t grain = opts.grainSize;
+        if (grain == 0)
+        {
+            const size_t chunks = std::max<size_t>(m_workerCount.load(std::memory_order_relaxed), 1) * 4;
+            grain = (count + chunks - 1) / chunks;
+        }
+        grain = std::max(align, (grain + align - 1) / align * align);
+
+        SubmitOptions chunkOpts{};
+        chunkOpts.label = opts.label;
+
+        std::vector<JobHandle> chunks;
+        chunks.reserve((count - 1) / grain);
+
+        // The first exception, from any chunk, is rethrown here; chunks not yet started are
+        // skipped. Chunks reference body: every submitted one must finish before it may leave.
+        std::exception_ptr error;
+        std::atomic<bool> failed{false};
+        auto runChunk = [&body, &error, &failed](size_t begin, size_t end) {
+            if (failed.load(std::memory_order_relaxed))
+                return;
+            try
+            {
+                body(begin, end);
+            }
+            catch (...)
+            {
+                if (!failed.exchange(true, std::memory_order_acq_rel))
+                    error = std::current_exception();
+            }
+        };
+
+        for (size_t begin = grain; begin < count; begin += grain)
+        {
+            const size_t end = std::min(count, begin + grain);
+            const JobHandle h = Submit(chunkOpts, [&runChunk, begin, end] { runChunk(begin, end); });
+            if (h)
+                chunks.push_back(h);
+            else
+                runChunk(begin, end);
+        }
+
+        runChunk(size_t(0), std::min(count, grain));
+
+        for (const JobHandle& h : chunks)
+            Wait(h);
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    template <typename Ready>
+    bool JobSystemBase::SpinUntil(Ready&& ready) const
+    {
+        for (uint32_t i = 0; i < m_idleSpins; ++i)
+        {
+            if (ready())
+                return true;
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    template <typename Ready>
+    void JobSystemBase::HelpUntil(Ready&& ready)
+    {
+        const detail::WaitTimer timer;
+        const bool help = CanHelp();
+        while (!ready())
+        {
+            if (help && HelpOne())
+                continue;
+            if (SpinUntil([&] { return ready() || (help && HasQueuedWork()); }))
+                continue;
+
+            // Announce the park before the final check; WakeHelpers pairs with it.
+            const uint32_t epoch = m_parkEpoch.load(std::memory_order_acquire);
+            m_parked.fetch_add(1, std::memory_order_seq_cst);
+            if (!ready() && !(help && HasQueuedWork()))
+                m_parkEpoch.wait(epoch, std::memory_order_acquire);
+            m_parked.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+} // namespace core
@@ -0,0 +1,1231 @@
+#pragma once
+
+// Out-of-line definitions of JobSystemT. JobSystem.cpp compiles the default configuration into
+// the library; include this header in one translation unit per other configuration you use.
+
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <xmmintrin.h>
+#endif
+
+namespace core
+{
+    namespace detail
+    {
+        // Front-end whose job is executing on this thread (null outside jobs).
+        inline thread_local const JobSystemBase* t_currentSystem = nullptr;
+
+        // Jobs nested on this thread's stack, across all front-ends.
+        inline thread_local uint32_t t_helpDepth = 0;
+
+        // Job currently executing on this thread; links spawned jobs to their parent.
+        inline thread_local uint64_t t_currentTaskId = 0;
+
+        // Jobs this thread submitted since its last sampled one.
+        inline thread_local uint32_t t_submitTick = 0;
+
+        // True for one call in every `every`.
+        inline bool SampleNext(uint32_t& tick, uint32_t every)
+        {
+            if (++tick < every)
+                return false;
+            tick = 0;
+            return true;
+        }
+
+        // Counters written only under m_mtx but read without it (GetStats): a plain load and
+        // store, no locked read-modify-write. Returns the new value.
+        inline uint64_t AddGuarded(std::atomic<uint64_t>& counter, int64_t delta)
+        {
+            const uint64_t v = counter.load(std::memory_order_relaxed) + (uint64_t)delta;
+            counter.store(v, std::memory_order_relaxed);
+            return v;
+        }
+
+        // Starts pulling a cache line in for a read that comes soon.
+        inline void Prefetch([[maybe_unused]] const void* p)
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(p);
+#endif
+        }
+
+        // Single-writer counters: a plain load and store, no locked read-modify-write.
+        inline void AddOwned(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    } // namespace detail
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemT<Q, I, T, S>::JobSystemT()
+        : JobSystemT(Config{})
+    {
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemT<Q, I, T, S>::JobSystemT(const Config& cfg)
+        : JobSystemBase(cfg, I::kSpins)
+    {
+        const uint32_t n = m_pool->WorkerCount();
+        m_workerCount.store(n, std::memory_order_relaxed);
+
+        m_slab = std::make_unique<std::atomic<SlabChunk*>[]>(kMaxSlabChunks);
+        if constexpr (kLocalQueues)
+        {
+            m_local = std::make_unique<LocalQueue[]>(n);
+            m_localCount = n;
+        }
+
+        if constexpr (kTelemetry)
+        {
+            // One extra entry records jobs run by threads outside the pool (see Wait).
+            m_workerTel = std::make_unique<WorkerTelemetry[]>(n + 1);
+            m_workerTelCount = n;
+            SetTelemetry(m_cfg.telemetry);
+        }
+
+        m_pool->Attach(this);
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemT<Q, I, T, S>::~JobSystemT()
+    {
+        Stop(StopMode::Drain);
+
+        for (uint32_t i = 0; i < m_slabChunks; ++i)
+            delete m_slab[i].load(std::memory_order_relaxed);
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    uint64_t JobSystemT<Q, I, T, S>::TaskId([[maybe_unused]] uint32_t index) const
+    {
+        if constexpr (kTelemetry)
+            return Links(index).traced ? Trace(index).id : 0;
+        else
+            return 0;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::AllocateSlot(uint32_t& out)
+    {
+        if (m_freeSlots.empty())
+        {
+            if (m_slabChunks == kMaxSlabChunks)
+                return false;
+
+            const uint32_t base = m_slabChunks * kSlabChunkSize;
+            m_slab[m_slabChunks++].store(new SlabChunk, std::memory_order_release);
+            m_freeSlots.reserve(m_freeSlots.size() + kSlabChunkSize);
+            for (uint32_t i = kSlabChunkSize; i-- > 0;)
+                m_freeSlots.push_back(base + i);
+        }
+
+        out = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return true;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    uint32_t JobSystemT<Q, I, T, S>::RetireSlot(uint32_t slot, bool& realtimeReleased)
+    {
+        TaskItem& item = Slot(slot);
+        const uint32_t next = item.generation.load(std::memory_order_relaxed) + 1;
+        item.generation.store(next != 0 ? next : 1, std::memory_order_seq_cst);
+
+        // notify_all is not free; pairs with the count taken in Wait before it blocks.
+        if (m_handleWaiters.load(std::memory_order_seq_cst) != 0)
+            item.generation.notify_all();
+
+        uint32_t released = 0;
+        SlotLinks& links = Links(slot);
+        for (uint32_t e = links.firstDependent; e != kNoEdge;)
+        {
+            const DependentEdge edge = m_edges[e];
+            m_edges[e].next = m_freeEdge;
+            m_freeEdge = e;
+            e = edge.next;
+
+            SlotLinks& dependent = Links(edge.slot);
+            if (--dependent.pendingDeps != 0)
+                continue;
+
+            m_queues[dependent.lane].push_back(edge.slot);
+            if constexpr (kTelemetry)
+            {
+                if (dependent.traced)
+                    Trace(edge.slot).readyNs = detail::NowNs();
+            }
+            detail::AddGuarded(m_waitingCount, -1);
+            detail::AddGuarded(m_sharedQueued, 1);
+            m_queuedCount.fetch_add(1, std::memory_order_seq_cst); // see HasQueuedWork
+            ++m_readiedCount;
+            realtimeReleased |= (dependent.lane == kLaneRealtime);
+            ++released;
+        }
+        links.firstDependent = kNoEdge;
+
+        m_freeSlots.push_back(slot);
+        return released;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemBase::JobHandle JobSystemT<Q, I, T, S>::Enqueue(const SubmitOptions& opts, ConstructFn construct, void* ctx)
+    {
+        if (!m_accepting.load(std::memory_order_acquire))
+            return JobHandle{};
+
+        // Sampled and recorded jobs get an id and a trace; the others only their label.
+        bool recording = false;
+        bool traced = false;
+        detail::TaskTrace trace{};
+        LabelId labelId = LabelRegistry::kNone;
+        if constexpr (kTelemetry)
+        {
+            recording = m_recording.load(std::memory_order_relaxed);
+            if (recording || m_telemetryOn.load(std::memory_order_relaxed))
+            {
+                labelId = opts.label.Id();
+                traced = recording || detail::SampleNext(detail::t_submitTick, m_sampleEvery.load(std::memory_order_relaxed));
+            }
+            if (traced)
+            {
+                trace.id = m_nextTaskId.fetch_add(1, std::memory_order_relaxed);
+                trace.parentId = (recording && detail::t_currentSystem == this) ? detail::t_currentTaskId : 0;
+                trace.readyNs = detail::NowNs();
+                trace.submitNs = recording ? trace.readyNs : 0;
+                trace.epoch = recording ? m_epoch.load(std::memory_order_relaxed) : 0;
+            }
+        }
+
+        const bool realtime = (opts.priority == Priority::Realtime);
+        const uint32_t lane = realtime ? kLaneRealtime : (opts.cores == CoreHint::HighCapacity) ? kLaneHighCapacity : kLaneAny;
+
+        // Plain jobs spawned by one of our workers stay with it (see TryDequeue).
+        const uint32_t self = m_pool->CurrentWorkerIndex();
+        const bool local = (kLocalQueues && lane == kLaneAny && self < m_localCount && !m_pool->IsRealtimeWorker(self));
+
+        JobHandle handle{};
+        uint64_t backlog = 0;
+        bool paused = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (!m_accepting.load(std::memory_order_relaxed))
+                return JobHandle{};
+            paused = m_paused.load(std::memory_order_relaxed);
+
+            uint32_t slot = 0;
+            if (!AllocateSlot(slot))
+                return JobHandle{};
+
+            TaskItem& item = Slot(slot);
+            try
+            {
+                construct(item, ctx);
+            }
+            catch (...)
+            {
+                m_freeSlots.push_back(slot);
+                throw;
+            }
+            item.slot = slot;
+
+            if constexpr (kTelemetry)
+            {
+                if (traced)
+                    Trace(slot) = trace;
+            }
+
+            SlotLinks& links = Links(slot);
+            links.lane = (uint8_t)lane;
+            links.pendingDeps = 0;
+            links.firstDependent = kNoEdge;
+            links.traced = traced;
+            links.labelId = labelId;
+
+            // A dependency still on its generation has not finished: hook onto it.
+            for (const JobHandle dep : opts.dependsOn)
+            {
+                if (!dep || (dep.index >> kSlabChunkShift) >= m_slabChunks)
+                    continue;
+                if (Slot(dep.index).generation.load(std::memory_order_relaxed) != dep.generation)
+                    continue;
+
+                uint32_t e = m_freeEdge;
+                if (e != kNoEdge)
+                    m_freeEdge = m_edges[e].next;
+                else
+                {
+                    e = (uint32_t)m_edges.size();
+                    m_edges.emplace_back();
+                }
+
+                SlotLinks& depLinks = Links(dep.index);
+                m_edges[e] = DependentEdge{slot, depLinks.firstDependent};
+                depLinks.firstDependent = e;
+                ++links.pendingDeps;
+
+                if constexpr (kTelemetry)
+                {
+                    if (recording)
+                        m_recordedDeps.emplace_back(trace.id, TaskId(dep.index));
+                }
+            }
+
+            if (links.pendingDeps == 0)
+            {
+                if (local)
+                {
+                    std::lock_guard<std::mutex> localLock(m_local[self].mtx);
+                    m_local[self].slots.push_back(slot);
+                }
+                else
+                {
+                    m_queues[lane].push_back(slot);
+                    detail::AddGuarded(m_sharedQueued, 1);
+                }
+                backlog = m_queuedCount.fetch_add(1, std::memory_order_seq_cst) + 1; // see HasQueuedWork
+                ++m_readiedCount;
+                if (m_idleHelpers != 0)
+                    m_cvIdle.notify_all(); // more work for jobs helping in WaitIdle
+            }
+            else
+                detail::AddGuarded(m_waitingCount, 1);
+
+            m_submitted.fetch_add(1, std::memory_order_relaxed);
+            handle = JobHandle{slot, item.generation.load(std::memory_order_relaxed)};
+        }
+
+        JOBKIT_PROFILE_SUBMIT(opts.label.Name());
+        if (backlog == 0)
+            return handle; // released by its last dependency
+
+        // While paused only our own waiting jobs may take it; Resume wakes the pool.
+        if (!paused)
+        {
+            // An idle ordinary worker may get there first; whoever dequeues it takes it.
+            if (realtime && m_pool->RealtimeWorkerCount() != 0)
+                m_pool->NotifyRealtime();
+            m_pool->NotifyOne(backlog);
+        }
+        WakeHelpers();
+        return handle;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::IsDone(JobHandle job) const
+    {
+        if (!job || (job.index >> kSlabChunkShift) >= kMaxSlabChunks)
+            return true;
+
+        const SlabChunk* chunk = m_slab[job.index >> kSlabChunkShift].load(std::memory_order_acquire);
+        return !chunk || chunk->items[job.index & (kSlabChunkSize - 1)].generation.load(std::memory_order_acquire) != job.generation;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::Wait(JobHandle job)
+    {
+        const detail::WaitTimer timer;
+        const uint32_t self = m_pool->CurrentWorkerIndex();
+        const bool help = CanHelp();
+        while (!IsDone(job))
+        {
+            TaskItem* task = nullptr;
+            if (help && TryDequeue(self, task, true))
+            {
+                RunTask(self, *task);
+                continue;
+            }
+
+            // Nothing to help with: the job is running or waiting on running work.
+            if (SpinUntil([&] { return IsDone(job) || (help && HasQueuedWork()); }))
+                continue;
+            m_handleWaiters.fetch_add(1, std::memory_order_seq_cst);
+            Slot(job.index).generation.wait(job.generation, std::memory_order_seq_cst);
+            m_handleWaiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::HelpOne()
+    {
+        if (!CanHelp())
+            return false;
+
+        const uint32_t self = m_pool->CurrentWorkerIndex();
+        TaskItem* task = nullptr;
+        if (!TryDequeue(self, task, true))
+            return false;
+        RunTask(self, *task);
+        return true;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::WaitIdle()
+    {
+        // Our own job is in flight, and so may be others waiting like it.
+        if (detail::t_currentSystem == this)
+        {
+            HelpUntilIdle();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_cvIdle.wait(lock, [this] {
+            // Acquire: a job taken off a local queue is counted in flight first.
+            const bool empty = (m_queuedCount.load(std::memory_order_acquire) == 0 &&
+                                m_waitingCount.load(std::memory_order_relaxed) == 0);
+            const bool noneInFlight = (m_inFlight.load(std::memory_order_acquire) == 0);
+            return empty && noneInFlight;
+        });
+
+        if constexpr (kTelemetry)
+            m_epoch.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::HelpUntilIdle()
+    {
+        const detail::WaitTimer timer;
+        const uint32_t self = m_pool->CurrentWorkerIndex();
+        const bool help = CanHelp();
+
+        std::unique_lock<std::mutex> lock(m_mtx);
+        ++m_idleHelpers;
+        for (;;)
+        {
+            // Jobs suspended below us on a stack are blocked here too, so counting them as
+            // idle is exact: nothing else is left to run.
+            const bool empty = (m_queuedCount.load(std::memory_order_acquire) == 0 &&
+                                m_waitingCount.load(std::memory_order_relaxed) == 0);
+            if (empty && m_inFlight.load(std::memory_order_acquire) == m_idleHelpers)
+                break;
+
+            // Keeps running queued work while paused: Pause waits for this job to finish. Queued
+            // work we cannot take (Any-lane jobs on a realtime worker, or a job someone else got
+            // first) is left to others: wait rather than spin, unless more came in meanwhile.
+            if (help && m_queuedCount.load(std::memory_order_relaxed) != 0)
+            {
+                const uint64_t readied = m_readiedCount;
+                lock.unlock();
+                TaskItem* task = nullptr;
+                const bool took = TryDequeue(self, task, true);
+                if (took)
+                    RunTask(self, *task);
+                lock.lock();
+                if (took || m_readiedCount != readied)
+                    continue;
+            }
+
+            m_cvIdle.wait(lock);
+        }
+        --m_idleHelpers;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::Pause()
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (!m_accepting.load(std::memory_order_relaxed))
+            return;
+
+        // Sequentially consistent with TakeLocal, which counts itself in flight before it
+        // checks for a pause: either it backs off or we wait for its job.
+        m_paused.store(true, std::memory_order_seq_cst);
+
+        // From inside one of our own jobs we cannot wait for in-flight work to finish.
+        if (detail::t_currentSystem == this)
+            return;
+
+        m_cvIdle.wait(lock, [this] {
+            return m_inFlight.load(std::memory_order_seq_cst) == 0;
+        });
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::Resume()
+    {
+        uint64_t backlog = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (!m_paused.exchange(false, std::memory_order_seq_cst)) // see HasQueuedWork
+                return;
+            backlog = m_queuedCount.load(std::memory_order_relaxed);
+        }
+
+        // Queued work may be deep; wake everyone and let idle workers go back to sleep.
+        m_pool->NotifyAll(backlog);
+        WakeHelpers();
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::Stop(StopMode mode)
+    {
+        bool expected = true;
+        if (!m_accepting.compare_exchange_strong(expected, false, std::memory_order_acq_rel))
+            return; // already stopping/stopped
+
+        uint64_t backlog = 0;
+        std::vector<TaskItem*> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (mode == StopMode::CancelPending)
+            {
+                auto drop = [&](std::deque<uint32_t>& q) {
+                    for (uint32_t slot : q)
+                        cancelled.push_back(&Slot(slot));
+                    m_queuedCount.fetch_sub(q.size(), std::memory_order_relaxed);
+                    q.clear();
+                };
+                for (std::deque<uint32_t>& q : m_queues)
+                    drop(q);
+                m_sharedQueued.store(0, std::memory_order_relaxed);
+                for (uint32_t w = 0; w < m_localCount; ++w)
+                {
+                    std::lock_guard<std::mutex> localLock(m_local[w].mtx);
+                    drop(m_local[w].slots);
+                }
+
+                // Waiting jobs go too. Every dependency edge leads to one of them, so all edges
+                // can be dropped and in-flight jobs will release nothing.
+                for (uint32_t slot = 0; slot < m_slabChunks * kSlabChunkSize; ++slot)
+                {
+                    SlotLinks& links = Links(slot);
+                    if (links.pendingDeps != 0)
+                        cancelled.push_back(&Slot(slot));
+                    links.pendingDeps = 0;
+                    links.firstDependent = kNoEdge;
+                }
+                m_edges.clear();
+                m_freeEdge = kNoEdge;
+                m_waitingCount.store(0, std::memory_order_relaxed);
+            }
+
+            m_paused.store(false, std::memory_order_relaxed);
+            backlog = m_queuedCount.load(std::memory_order_relaxed);
+        }
+
+        // Dropped callables are destroyed outside the lock, as their destructors may run user
+        // code. The slab no longer grows: Submit fails from here on.
+        for (TaskItem* item : cancelled)
+            item->invoke(*item, false);
+        if (!cancelled.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            bool realtimeReleased = false;
+            for (TaskItem* item : cancelled)
+                RetireSlot(item->slot, realtimeReleased);
+        }
+        m_pool->NotifyAll(backlog); // drain whatever Pause() held back
+
+        // If draining, wait for queue+inFlight to become idle.
+        if (mode == StopMode::Drain)
+            WaitIdle();
+        else
+        {
+            // CancelPending: only wait for in-flight to finish.
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_cvIdle.wait(lock, [this] {
+                return (m_inFlight.load(std::memory_order_acquire) == 0);
+            });
+        }
+
+        // Leave the pool. A private pool joins its threads here.
+        m_pool->Detach(this);
+        if (m_ownsPool)
+            m_pool->Shutdown();
+        m_workerCount.store(0, std::memory_order_relaxed);
+
+        if constexpr (kTelemetry)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_telemetryMtx);
+                UpdatePoolCounters(); // no longer accepting: lets go of the pool's counters
+            }
+            // The worker telemetry stays until destruction: exporters and watchdogs may still
+            // be reading it.
+            m_recording.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemBase::Stats JobSystemT<Q, I, T, S>::GetStats() const
+    {
+        Stats s{};
+        s.workerCount = m_workerCount.load(std::memory_order_relaxed);
+        s.startedWorkers = (s.workerCount == 0) ? 0 : m_pool->StartedWorkerCount();
+        s.realtimeWorkersApplied = m_pool->RealtimeWorkersApplied();
+        s.paused = m_paused.load(std::memory_order_relaxed);
+
+        s.inFlight = m_inFlight.load(std::memory_order_acquire);
+        s.submitted = m_submitted.load(std::memory_order_relaxed);
+        s.completed = m_completed.load(std::memory_order_relaxed);
+
+        s.queued = m_queuedCount.load(std::memory_order_relaxed);
+        s.waiting = m_waitingCount.load(std::memory_order_relaxed);
+
+        return s;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemBase::Diagnostics JobSystemT<Q, I, T, S>::GetDiagnostics() const requires T::kEnabled
+    {
+        Diagnostics d{};
+        d.stats = GetStats();
+        d.workers = GetWorkerDiagnostics();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            d.queuedTasks.reserve(m_queuedCount.load(std::memory_order_relaxed));
+            auto list = [&](const std::deque<uint32_t>& q) {
+                for (uint32_t slot : q)
+                {
+                    Diagnostics::QueuedTask qt{};
+                    qt.id = TaskId(slot);
+                    qt.labelId = Links(slot).labelId;
+                    qt.label = LabelRegistry::Name(qt.labelId);
+                    d.queuedTasks.push_back(qt);
+                }
+            };
+            for (const std::deque<uint32_t>& q : m_queues)
+                list(q);
+            for (uint32_t w = 0; w < m_localCount; ++w)
+            {
+                std::lock_guard<std::mutex> localLock(m_local[w].mtx);
+                list(m_local[w].slots);
+            }
+        }
+
+        return d;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    std::vector<JobSystemBase::Diagnostics::Worker> JobSystemT<Q, I, T, S>::GetWorkerDiagnostics() const
+    {
+        const uint32_t n = m_workerTelCount;
+        std::vector<Diagnostics::Worker> workers(n);
+
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            Diagnostics::Worker w{};
+            w.workerIndex = i;
+            w.osThreadId = m_workerTel[i].osThreadId.load(std::memory_order_relaxed);
+            w.running = m_workerTel[i].running.load(std::memory_order_acquire);
+            w.runningTaskId = m_workerTel[i].runningTaskId.load(std::memory_order_acquire);
+            w.runningLabelId = m_workerTel[i].runningLabelId.load(std::memory_order_acquire);
+            w.runningLabel = LabelRegistry::Name(w.runningLabelId);
+            w.runningSinceNs = m_workerTel[i].runningSinceNs.load(std::memory_order_relaxed);
+            w.busyNs = m_workerTel[i].busyNs.load(std::memory_order_relaxed);
+            w.jobsExecuted = m_workerTel[i].jobsExecuted.load(std::memory_order_relaxed);
+            w.steals = m_workerTel[i].steals.load(std::memory_order_relaxed);
+            w.failedSteals = m_workerTel[i].failedSteals.load(std::memory_order_relaxed);
+
+            const ThreadPool::WorkerCounters pc = m_pool->GetWorkerCounters(i);
+            w.spinNs = pc.spinNs;
+            w.parkedNs = pc.parkedNs;
+            w.wakeups = pc.wakeups;
+            w.spuriousWakeups = pc.spuriousWakeups;
+            workers[i] = w;
+        }
+
+        return workers;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemBase::QueueAges JobSystemT<Q, I, T, S>::GetQueueAges(int64_t thresholdNs) const
+    {
+        QueueAges ages{};
+        if constexpr (!kTelemetry)
+            return ages;
+        const int64_t now = detail::NowNs();
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto scan = [&](const std::deque<uint32_t>& q) {
+            for (uint32_t slot : q)
+            {
+                ++ages.ready;
+                if (!Links(slot).traced)
+                    continue; // not sampled
+                int64_t readyNs = 0;
+                if constexpr (kTelemetry)
+                    readyNs = Trace(slot).readyNs;
+                const int64_t age = now - readyNs;
+                ages.olderThan += (age > thresholdNs) ? 1 : 0;
+                ages.oldestNs = std::max(ages.oldestNs, age);
+            }
+        };
+        for (const std::deque<uint32_t>& q : m_queues)
+            scan(q);
+        for (uint32_t w = 0; w < m_localCount; ++w)
+        {
+            std::lock_guard<std::mutex> localLock(m_local[w].mtx);
+            scan(m_local[w].slots);
+        }
+        return ages;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    std::vector<JobSystemBase::LabelHistogram> JobSystemT<Q, I, T, S>::GetLabelHistograms() const
+    {
+        // Summed per id; ids are interned, so each stands for one label text.
+        std::vector<LabelHistogram> byId(LabelRegistry::Count());
+        for (uint32_t i = 0; i < m_workerTelCount; ++i)
+        {
+            const WorkerTelemetry& tel = m_workerTel[i];
+            for (uint32_t c = 0; c < std::size(tel.labelChunks); ++c)
+            {
+                const typename WorkerTelemetry::LabelSlot* chunk = tel.labelChunks[c].load(std::memory_order_acquire);
+                for (uint32_t j = 0; chunk && j < WorkerTelemetry::kLabelChunk; ++j)
+                {
+                    const typename WorkerTelemetry::LabelSlot& slot = chunk[j];
+                    const uint64_t count = slot.count.load(std::memory_order_relaxed);
+                    const uint32_t id = c * WorkerTelemetry::kLabelChunk + j;
+                    if (count == 0 || id >= byId.size())
+                        continue;
+
+                    LabelHistogram& h = byId[id];
+                    for (size_t b = 0; b < kLabelHistogramBuckets; ++b)
+                        h.buckets[b] += slot.buckets[b].load(std::memory_order_relaxed);
+                    h.count += count;
+                    h.sumNs += slot.sumNs.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::vector<LabelHistogram> out;
+        for (uint32_t id = 0; id < byId.size(); ++id)
+        {
+            if (byId[id].count == 0)
+                continue;
+            byId[id].labelId = (LabelId)id;
+            byId[id].label = LabelRegistry::Name((LabelId)id);
+            out.push_back(std::move(byId[id]));
+        }
+        std::sort(out.begin(), out.end(), [](const LabelHistogram& a, const LabelHistogram& b) {
+            return a.label < b.label;
+        });
+        return out;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::RecordLabelTime(WorkerTelemetry& tel, LabelId label, int64_t ns)
+    {
+        std::atomic<typename WorkerTelemetry::LabelSlot*>& chunk = tel.labelChunks[label / WorkerTelemetry::kLabelChunk];
+        typename WorkerTelemetry::LabelSlot* slots = chunk.load(std::memory_order_relaxed);
+        if (!slots)
+        {
+            slots = new typename WorkerTelemetry::LabelSlot[WorkerTelemetry::kLabelChunk];
+            chunk.store(slots, std::memory_order_release);
+        }
+        typename WorkerTelemetry::LabelSlot* slot = &slots[label % WorkerTelemetry::kLabelChunk];
+
+        size_t b = 0;
+        while (b < kLabelHistogramBuckets - 1 && ns > kLabelHistogramBoundsNs[b])
+            ++b;
+        detail::AddOwned(slot->buckets[b], 1);
+        detail::AddOwned(slot->count, 1);
+        detail::AddOwned(slot->sumNs, (uint64_t)ns);
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::StartRecording() requires T::kEnabled
+    {
+        if (!m_accepting.load(std::memory_order_acquire))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_recording.load(std::memory_order_relaxed))
+            return false;
+
+        for (uint32_t i = 0; i <= m_workerTelCount; ++i)
+        {
+            std::lock_guard<std::mutex> recLock(m_workerTel[i].recordMtx);
+            m_workerTel[i].recorded.clear();
+        }
+        m_recordedDeps.clear();
+
+        m_recordOriginNs.store(detail::NowNs(), std::memory_order_relaxed);
+        m_recording.store(true, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    ScheduleTrace JobSystemT<Q, I, T, S>::StopRecording() requires T::kEnabled
+    {
+        ScheduleTrace trace{};
+
+        std::vector<RecordedJob> jobs;
+        std::vector<std::pair<uint64_t, uint64_t>> deps;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (!m_recording.exchange(false, std::memory_order_acq_rel))
+                return trace;
+
+            deps.swap(m_recordedDeps);
+            trace.workerCount = m_workerTelCount;
+            for (uint32_t i = 0; i <= m_workerTelCount; ++i)
+            {
+                std::lock_guard<std::mutex> recLock(m_workerTel[i].recordMtx);
+                jobs.insert(jobs.end(), m_workerTel[i].recorded.begin(), m_workerTel[i].recorded.end());
+                m_workerTel[i].recorded.clear();
+            }
+        }
+
+        std::sort(jobs.begin(), jobs.end(), [](const RecordedJob& a, const RecordedJob& b) {
+            return a.id < b.id;
+        });
+        std::sort(deps.begin(), deps.end());
+        auto nextDep = deps.begin();
+
+        const int64_t originNs = m_recordOriginNs.load(std::memory_order_relaxed);
+
+        std::vector<uint32_t> labelIndex(LabelRegistry::kMaxLabels, UINT32_MAX); // by label id
+        trace.records.reserve(jobs.size());
+        for (const RecordedJob& j : jobs)
+        {
+            ScheduleRecord r{};
+            r.id = j.id;
+            r.parentId = j.parentId;
+            r.epoch = j.epoch;
+            r.worker = j.worker;
+            r.submitNs = j.submitNs - originNs;
+            r.startNs = j.startNs - originNs;
+            r.durationNs = j.endNs - j.startNs - j.nestedNs;
+
+            while (nextDep != deps.end() && nextDep->first < j.id)
+                ++nextDep;
+            for (; nextDep != deps.end() && nextDep->first == j.id; ++nextDep)
+                r.dependencies.push_back(nextDep->second);
+
+            if (j.labelId != LabelRegistry::kNone)
+            {
+                uint32_t& index = labelIndex[j.labelId];
+                if (index == UINT32_MAX)
+                {
+                    index = (uint32_t)trace.labels.size();
+                    trace.labels.emplace_back(LabelRegistry::Name(j.labelId));
+                }
+                r.labelIndex = index;
+            }
+
+            trace.records.push_back(std::move(r));
+        }
+
+        return trace;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::RecordJob(uint32_t workerIndex, const detail::TaskTrace& trace, LabelId label, int64_t startNs,
+                                           int64_t endNs, int64_t nestedNs) requires T::kEnabled
+    {
+        WorkerTelemetry& tel = m_workerTel[workerIndex];
+
+        std::lock_guard<std::mutex> lock(tel.recordMtx);
+        if (!m_recording.load(std::memory_order_relaxed))
+            return; // recording stopped while the job ran
+
+        if (trace.submitNs < m_recordOriginNs.load(std::memory_order_relaxed))
+            return; // submitted during an earlier recording
+
+        RecordedJob r{};
+        r.id = trace.id;
+        r.parentId = trace.parentId;
+        r.labelId = label;
+        r.epoch = trace.epoch;
+        r.worker = workerIndex;
+        r.submitNs = trace.submitNs;
+        r.startNs = startNs;
+        r.endNs = endNs;
+        r.nestedNs = nestedNs;
+        tel.recorded.push_back(r);
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::SetTelemetry(const TelemetrySettings& settings) requires T::kEnabled
+    {
+        std::lock_guard<std::mutex> lock(m_telemetryMtx);
+        m_telemetry = settings;
+        m_telemetry.sampleEvery = std::max<uint32_t>(settings.sampleEvery, 1);
+        // Ends any detailed capture: with telemetry off no job would reach its end check.
+        m_detailedUntilNs.store(0, std::memory_order_relaxed);
+        m_sampleEvery.store(m_telemetry.sampleEvery, std::memory_order_relaxed);
+        m_telemetryOn.store(m_telemetry.enabled, std::memory_order_relaxed);
+        UpdatePoolCounters();
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    JobSystemBase::TelemetrySettings JobSystemT<Q, I, T, S>::GetTelemetry() const
+    {
+        if constexpr (!kTelemetry)
+            return TelemetrySettings{false, 1};
+        std::lock_guard<std::mutex> lock(m_telemetryMtx);
+        return m_telemetry;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::CaptureDetailed(std::chrono::nanoseconds duration) requires T::kEnabled
+    {
+        std::lock_guard<std::mutex> lock(m_telemetryMtx);
+        m_detailedUntilNs.store(detail::NowNs() + std::max<int64_t>(duration.count(), 1), std::memory_order_relaxed);
+        m_sampleEvery.store(1, std::memory_order_relaxed);
+        m_telemetryOn.store(true, std::memory_order_relaxed);
+        UpdatePoolCounters();
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::EndDetailedCapture(int64_t nowNs) requires T::kEnabled
+    {
+        // First sampled job past the deadline; the others find the capture already ended.
+        std::lock_guard<std::mutex> lock(m_telemetryMtx);
+        const int64_t until = m_detailedUntilNs.load(std::memory_order_relaxed);
+        if (until == 0 || nowNs <= until)
+            return;
+        m_detailedUntilNs.store(0, std::memory_order_relaxed);
+        m_sampleEvery.store(m_telemetry.sampleEvery, std::memory_order_relaxed);
+        m_telemetryOn.store(m_telemetry.enabled, std::memory_order_relaxed);
+        UpdatePoolCounters();
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::UpdatePoolCounters() requires T::kEnabled
+    {
+        const bool want = m_telemetryOn.load(std::memory_order_relaxed) && m_accepting.load(std::memory_order_relaxed);
+        if (want == m_poolCounters)
+            return;
+        if (want)
+            m_pool->RetainCounters();
+        else
+            m_pool->ReleaseCounters();
+        m_poolCounters = want;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::TryDequeue(uint32_t workerIndex, TaskItem*& out, bool newest, bool nearOnly)
+    {
+        // Realtime jobs come first for every worker and are the only jobs realtime workers take.
+        // Workers on high-capacity cores then take HighCapacity jobs, and every worker its own
+        // local jobs, newest first, while their data is still in cache. Then the shared lanes;
+        // little cores only pick up HighCapacity jobs when nothing else is left. Last, steal
+        // the oldest local job of another worker, the one its owner would get to last, trying
+        // workers that share our core or cache first.
+        const bool big = m_pool->IsHighCapacityWorker(workerIndex);
+        const bool realtimeOnly = m_pool->IsRealtimeWorker(workerIndex);
+        const bool hasLocal = kLocalQueues && workerIndex < m_localCount;
+
+        if (m_queuedCount.load(std::memory_order_relaxed) == 0 || HeldByPause())
+            return false;
+
+        // The shared lanes need m_mtx; the local queues only their own lock.
+        auto takeShared = [&](bool beforeLocal) {
+            if (m_sharedQueued.load(std::memory_order_relaxed) == 0)
+                return false;
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (HeldByPause())
+                return false;
+            if (beforeLocal)
+                return TakeFrom(m_queues[kLaneRealtime], newest, out) ||
+                       (big && !realtimeOnly && TakeFrom(m_queues[kLaneHighCapacity], newest, out));
+            return TakeFrom(m_queues[kLaneAny], newest, out) ||
+                   (!big && TakeFrom(m_queues[kLaneHighCapacity], newest, out));
+        };
+
+        out = nullptr;
+        if (takeShared(true))
+            return true;
+        if (realtimeOnly)
+            return false;
+        if (hasLocal && TakeLocal(workerIndex, true, out))
+            return true;
+        if (takeShared(false))
+            return true;
+        if constexpr (!kLocalQueues)
+            return false;
+
+        if (!hasLocal)
+        {
+            for (uint32_t victim = 0; victim < m_localCount; ++victim)
+            {
+                if (TakeLocal(victim, false, out))
+                {
+                    JOBKIT_PROFILE_STEAL(workerIndex, victim);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::span<const uint32_t> victims = m_pool->StealOrder(workerIndex);
+        if (nearOnly)
+            victims = victims.first(m_pool->NearVictimCount(workerIndex));
+        for (uint32_t victim : victims)
+        {
+            if (TakeLocal(victim, false, out))
+            {
+                JOBKIT_PROFILE_STEAL(workerIndex, victim);
+                if constexpr (kTelemetry)
+                    detail::AddOwned(m_workerTel[workerIndex].steals, 1);
+                return true;
+            }
+        }
+        if constexpr (kTelemetry)
+        {
+            if (!victims.empty())
+                detail::AddOwned(m_workerTel[workerIndex].failedSteals, 1);
+        }
+        return false;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    typename JobSystemT<Q, I, T, S>::TaskItem* JobSystemT<Q, I, T, S>::PopSlot(std::deque<uint32_t>& q, bool back)
+    {
+        TaskItem* item = nullptr;
+        if (back)
+        {
+            item = &Slot(q.back());
+            q.pop_back();
+        }
+        else
+        {
+            item = &Slot(q.front());
+            q.pop_front();
+        }
+
+        // Counted in flight by the caller before it leaves the queued count, so idle checks
+        // never see it in neither.
+        m_queuedCount.fetch_sub(1, std::memory_order_release);
+
+        // The next job's slot is likely cold; start pulling it in for whoever takes it from
+        // the same end.
+        if (!q.empty())
+            detail::Prefetch(&Slot(back ? q.back() : q.front()));
+        return item;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::TakeFrom(std::deque<uint32_t>& q, bool back, TaskItem*& out)
+    {
+        out = nullptr;
+        if (q.empty())
+            return false;
+
+        m_inFlight.fetch_add(1, std::memory_order_acq_rel);
+        detail::AddGuarded(m_sharedQueued, -1);
+        out = PopSlot(q, back);
+        return true;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::TakeLocal(uint32_t worker, bool back, TaskItem*& out)
+    {
+        LocalQueue& local = m_local[worker];
+        {
+            std::lock_guard<std::mutex> lock(local.mtx);
+            if (local.slots.empty())
+                return false;
+
+            // Without m_mtx, Pause may land between its check and ours: count the job in
+            // flight first, then look again (see Pause).
+            m_inFlight.fetch_add(1, std::memory_order_seq_cst);
+            if (!m_paused.load(std::memory_order_seq_cst) || detail::t_currentSystem == this)
+            {
+                out = PopSlot(local.slots, back);
+                return true;
+            }
+        }
+
+        // Paused after all: hand the count back and let Pause see it.
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_inFlight.fetch_sub(1, std::memory_order_acq_rel);
+        m_cvIdle.notify_all();
+        return false;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::HeldByPause() const
+    {
+        return m_paused.load(std::memory_order_relaxed) && detail::t_currentSystem != this;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::PoolDequeue(uint32_t workerIndex, bool nearOnly, void*& task)
+    {
+        TaskItem* item = nullptr;
+        if (!TryDequeue(workerIndex, item, false, nearOnly))
+            return false;
+        task = item;
+        return true;
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::PoolRun(uint32_t workerIndex, void* task)
+    {
+        RunTask(workerIndex, *static_cast<TaskItem*>(task));
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    bool JobSystemT<Q, I, T, S>::HasQueuedWork() const
+    {
+        // Polled by idle and waiting threads: no lock, like the check in TryDequeue. Sequentially
+        // consistent with the updates made before WakeHelpers, so a helper checking before it
+        // parks either sees the work or gets woken (see HelpUntil).
+        return m_queuedCount.load(std::memory_order_seq_cst) != 0 &&
+               !(m_paused.load(std::memory_order_seq_cst) && detail::t_currentSystem != this);
+    }
+
+    template <typename Q, typename I, typename T, typename S>
+    void JobSystemT<Q, I, T, S>::RunTask(uint32_t workerIndex, TaskItem& task)
+    {
+        // Jobs run while helping in Wait nest; the outer job shows again once they return.
+        WorkerTelemetry* tel = nullptr;
+        uint32_t every = 1;
+        bool sampled = false;
+        bool timed = false;
+        bool outermost = false;
+        int64_t startNs = 0;
+        bool outerRunning = false;
+        uint64_t outerTaskId = 0;
+        LabelId outerLabelId = LabelRegistry::kNone;
+        int64_t outerSinceNs = 0;
+        uint64_t prevTaskId = 0;
+        int64_t outerNestedNs = 0;
+        LabelId labelId = LabelRegistry::kNone;
+        const detail::TaskTrace* trace = nullptr; // sampled or recorded jobs only
+        if constexpr (kTelemetry)
+        {
+            const SlotLinks& links = Links(task.slot);
+            labelId = links.labelId;
+            if (links.traced)
+                trace = &Trace(task.slot);
+
+            if (workerIndex < m_workerTelCount && m_telemetryOn.load(std::memory_order_relaxed))
+            {
+                tel = &m_workerTel[workerIndex];
+                every = m_sampleEvery.load(std::memory_order_relaxed);
+                sampled = detail::SampleNext(tel->sampleTick, every);
+            }
+
+            // Recorded and sampled labelled jobs are timed. A job run while a timed one helps is
+            // timed too, so that its time can be taken out of the outer job's. Workers also
+            // publish sampled jobs' start for the stall watchdog.
+            timed = ((trace && trace->submitNs != 0) || (sampled && labelId != LabelRegistry::kNone) || detail::t_timedDepth != 0);
+            outermost = (sampled && detail::t_helpDepth == 0); // busy time, counted once per stack
+            startNs = (timed || sampled) ? detail::NowNs() : 0;
+
+            const uint64_t taskId = trace ? trace->id : 0;
+            if (tel)
+            {
+                outerRunning = tel->running.load(std::memory_order_relaxed);
+                outerTaskId = tel->runningTaskId.load(std::memory_order_relaxed);
+                outerLabelId = tel->runningLabelId.load(std::memory_order_relaxed);
+                outerSinceNs = tel->runningSinceNs.load(std::memory_order_relaxed);
+                tel->osThreadId.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                tel->running.store(true, std::memory_order_release);
+                tel->runningSinceNs.store(sampled ? startNs : 0, std::memory_order_relaxed);
+                tel->runningLabelId.store(labelId, std::memory_order_release);
+                tel->runningTaskId.store(taskId, std::memory_order_release);
+            }
+
+            prevTaskId = detail::t_currentTaskId;
+            detail::t_currentTaskId = taskId;
+            outerNestedNs = detail::t_nestedNs;
+            detail::t_nestedNs = 0;
+            detail::t_timedDepth += timed ? 1 : 0;
+        }
+
+        const JobSystemBase* prevSystem = detail::t_currentSystem;
+        detail::t_currentSystem = this;
+        ++detail::t_helpDepth;
+
+        // Execute outside lock. The invoker destroys the callable either way.
+        JOBKIT_PROFILE_JOB_BEGIN(LabelRegistry::Name(labelId), workerIndex);
+        try
+        {
+            task.invoke(task, true);
+        }
+        catch (...)
+        {
+            // Swallow exceptions to avoid killing worker threads.
+        }
+        JOBKIT_PROFILE_JOB_END(LabelRegistry::Name(labelId), workerIndex);
+
+        --detail::t_helpDepth;
+        detail::t_currentSystem = prevSystem;
+
+        if constexpr (kTelemetry)
+        {
+            detail::t_currentTaskId = prevTaskId;
+
+            const int64_t endNs = (timed || outermost) ? detail::NowNs() : 0;
+            if (tel)
+            {
+                detail::AddOwned(tel->jobsExecuted, 1);
+                if (outermost)
+                    detail::AddOwned(tel->busyNs, (uint64_t)(endNs - startNs) * every);
+                const int64_t detailedUntilNs = m_detailedUntilNs.load(std::memory_order_relaxed);
+                if (detailedUntilNs != 0 && endNs > detailedUntilNs)
+                    EndDetailedCapture(endNs);
+            }
+
+            if (timed)
+            {
+                --detail::t_timedDepth;
+
+                // Threads outside the pool record into the extra last entry.
+                if (trace && trace->submitNs != 0)
+                    RecordJob(std::min(workerIndex, m_workerTelCount), *trace, labelId, startNs, endNs, detail::t_nestedNs);
+                if (sampled && labelId != LabelRegistry::kNone)
+                    RecordLabelTime(*tel, labelId, endNs - startNs - detail::t_nestedNs);
+                detail::t_nestedNs = outerNestedNs + (endNs - startNs);
+            }
+            else
+                detail::t_nestedNs = outerNestedNs;
+
+            if (tel)
+            {
+                tel->running.store(outerRunning, std::memory_order_release);
+                tel->runningSinceNs.store(outerSinceNs, std::memory_order_relaxed);
+                tel->runningLabelId.store(outerLabelId, std::memory_order_release);
+                tel->runningTaskId.store(outerTaskId, std::memory_order_release);
+            }
+        }
+
+        m_completed.fetch_add(1, std::memory_order_relaxed);
+
+        // Last touch of this front-end: once in-flight drops, Stop() may detach and return.
+        // The pool's threads are joined only after this returns, so it is still safe to use.
+        ThreadPool* pool = m_pool.get();
+        uint32_t released = 0;
+        bool realtimeReleased = false;
+        uint64_t backlog = 0;
+        bool paused = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            released = RetireSlot(task.slot, realtimeReleased);
+            backlog = m_queuedCount.load(std::memory_order_relaxed);
+            paused = m_paused.load(std::memory_order_relaxed);
+            if (released != 0)
+                WakeHelpers(); // before in-flight drops and Stop() may return
+            m_inFlight.fetch_sub(1, std::memory_order_acq_rel);
+
+            // Waiters re-check their own predicate (queue may be non-empty while paused).
+            // Jobs in WaitIdle also want to hear about released dependents they could run.
+            if (m_inFlight.load(std::memory_order_acquire) == m_idleHelpers || (released != 0 && m_idleHelpers != 0))
+                m_cvIdle.notify_all();
+        }
+
+        if (paused)
+            return; // Resume wakes the pool
+        if (realtimeReleased && pool->RealtimeWorkerCount() != 0)
+            pool->NotifyRealtime();
+        for (uint32_t i = 0; i < released; ++i)
+            pool->NotifyOne(backlog);
+    }
+} // namespace core
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef JOBSYS_TELEMETRY
+    #define JOBSYS_TELEMETRY 0
+#endif
+
+namespace core
+{
+    // Compile-time policies for JobSystemT. Each is a tag with constexpr settings; whatever a
+    // policy turns off is compiled out of the scheduler rather than skipped at run time.
+
+    // Where jobs queue. WorkStealingQueues keeps plain jobs a worker submits in its own deque,
+    // run newest first and stolen oldest first by the others. SharedQueues puts every job in
+    // the shared lanes: no per-worker deques or steal passes, e.g. for single-core tools.
+    struct WorkStealingQueues
+    {
+        static constexpr bool kLocalQueues = true;
+    };
+
+    struct SharedQueues
+    {
+        static constexpr bool kLocalQueues = false;
+    };
+
+    // How a thread blocked inside the system (Wait, HelpUntil and the Sync.h waits) idles once
+    // there is nothing to help with: yield up to Spins times re-checking, then park on a futex.
+    // Spinning trades CPU for wake-up latency. Pool workers idle as ThreadPool::Config says.
+    template <uint32_t Spins>
+    struct SpinThenPark
+    {
+        static constexpr uint32_t kSpins = Spins;
+    };
+
+    using ParkWhenIdle = SpinThenPark<0>;
+
+    // Per-job ids and labels, worker diagnostics, label histograms and schedule recording.
+    // FullTelemetry is the default and can be switched at run time (TelemetrySettings);
+    // JOBSYS_TELEMETRY only decides whether it starts on. NoTelemetry compiles it out.
+    struct NoTelemetry
+    {
+        static constexpr bool kEnabled = false;
+    };
+
+    struct FullTelemetry
+    {
+        static constexpr bool kEnabled = true;
+    };
+
+    using DefaultTelemetry = FullTelemetry;
+
+    // Callable bytes kept inline in a task slot; larger captures go to the heap. Slots are
+    // padded to whole cache lines, so 48 (one line) or 112 (two) waste none.
+    template <size_t Bytes>
+    struct InlineTaskStorage
+    {
+        static constexpr size_t kInlineBytes = Bytes;
+    };
+
+    using DefaultTaskStorage = InlineTaskStorage<48>;
+} // namespace core
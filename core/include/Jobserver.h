@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace core
+{
+    // Client side of the GNU make jobserver protocol.
+    //
+    // make -jN hands every child process one implicit job slot plus access to a shared pool of
+    // N-1 tokens (bytes in a pipe or named fifo; a named semaphore on Windows). A process that
+    // wants more parallelism reads a token before starting extra work and writes the same byte
+    // back when done, so total parallelism across all processes stays within -jN.
+    class JobserverClient
+    {
+    public:
+        // Parses --jobserver-auth= (or the older --jobserver-fds=) from MAKEFLAGS.
+        // Returns null when no usable jobserver is advertised.
+        static std::unique_ptr<JobserverClient> FromEnvironment();
+
+        // auth is the value of --jobserver-auth: "R,W" (inherited fds), "fifo:PATH", or a
+        // semaphore name on Windows.
+        static std::unique_ptr<JobserverClient> FromAuth(const std::string& auth);
+
+        ~JobserverClient();
+
+        JobserverClient(const JobserverClient&) = delete;
+        JobserverClient& operator=(const JobserverClient&) = delete;
+
+        // Waits up to timeoutMs for a token. On success stores the byte that must be handed back.
+        bool TryAcquire(uint32_t timeoutMs, char& token);
+        void Release(char token);
+
+    private:
+        JobserverClient() = default;
+
+#if defined(_WIN32)
+        void* m_semaphore = nullptr;
+#else
+        int m_readFd = -1;
+        int m_writeFd = -1;
+        bool m_ownsReadFd = false; // fifo or private reopen of the inherited pipe
+#endif
+    };
+} // namespace core
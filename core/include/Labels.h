@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+namespace core
+{
+    // Job labels are interned once into small integer ids, so per-label statistics, histograms
+    // and traces are plain arrays indexed by id. Ids are process-wide and never reused; names
+    // stay valid for the life of the process.
+    using LabelId = uint16_t;
+
+    class LabelRegistry
+    {
+    public:
+        static constexpr LabelId kNone = 0;
+        static constexpr LabelId kOther = 1; // "(other)": every name past kMaxLabels
+        static constexpr uint32_t kMaxLabels = 4096;
+
+        // Same text, same id. Thread-safe; repeated calls with the same pointer hit a small
+        // per-thread cache, checked with one string compare. Null and "" are kNone.
+        static LabelId Intern(const char* name);
+
+        // Lock-free. Null for kNone and ids not handed out.
+        static const char* Name(LabelId id);
+
+        // Ids handed out so far are below this.
+        static uint32_t Count();
+    };
+
+    // A job label as given to Submit: a name interned when the job is accepted, or an id that
+    // already was. Converts from const char* for existing call sites.
+    struct Label
+    {
+        Label() = default;
+        Label(const char* text)
+            : name(text)
+        {
+        }
+        explicit Label(LabelId interned)
+            : id(interned)
+        {
+        }
+
+        LabelId Id() const { return id != LabelRegistry::kNone ? id : LabelRegistry::Intern(name); }
+        const char* Name() const { return name ? name : LabelRegistry::Name(id); }
+        explicit operator bool() const { return name != nullptr || id != LabelRegistry::kNone; }
+
+        const char* name = nullptr;
+        LabelId id = LabelRegistry::kNone;
+    };
+} // namespace core
+
+// A label interned on first use at this call site, e.g. opts.label = JOBKIT_LABEL("Physics").
+#define JOBKIT_LABEL(name) \
+    ([]() -> ::core::Label { static const ::core::LabelId jobkitLabelId = ::core::LabelRegistry::Intern(name); return ::core::Label(jobkitLabelId); }())
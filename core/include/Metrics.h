@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "JobSystem.h"
+
+namespace core
+{
+    struct MetricsOptions
+    {
+        std::string prefix = "jobkit"; // metric family name prefix
+        std::string system;            // adds system="..." to every sample; empty = omitted
+    };
+
+    // OpenMetrics text exposition of the system's Stats and, with FullTelemetry, its
+    // per-worker counters and per-label run-time histograms. Takes no scheduler lock, so a
+    // scrape never stalls job submission or execution; it may also run while the system
+    // stops. Ends with "# EOF".
+    std::string RenderOpenMetrics(const JobSystemBase& js, const MetricsOptions& opts = {});
+
+    // Replaces path atomically (a temporary file next to it, then rename), as textfile
+    // collectors such as node_exporter's expect. Returns false on I/O errors.
+    bool WriteOpenMetricsFile(const JobSystemBase& js, const char* path, const MetricsOptions& opts = {});
+
+    // Renders the metrics on its own thread every interval and hands them to the callback
+    // and/or writes them to a textfile. Stops on destruction; must not outlive the JobSystem.
+    class MetricsExporter
+    {
+    public:
+        struct Config
+        {
+            std::chrono::milliseconds interval{1000};
+            std::function<void(const std::string&)> callback; // runs on the exporter thread
+            std::string textfilePath;                          // empty = no file
+            MetricsOptions format;
+        };
+
+        MetricsExporter(const JobSystemBase& js, Config cfg);
+        ~MetricsExporter();
+
+        MetricsExporter(const MetricsExporter&) = delete;
+        MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+        // One export outside the schedule. Returns false if the textfile could not be written.
+        bool ExportNow();
+
+    private:
+        void Run(std::stop_token st);
+
+        const JobSystemBase& m_js;
+        const Config m_cfg;
+        std::mutex m_exportMtx; // serializes ExportNow with the periodic export
+        std::mutex m_sleepMtx;
+        std::condition_variable_any m_cv;
+        std::jthread m_thread;
+    };
+} // namespace core
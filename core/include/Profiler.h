@@ -0,0 +1,44 @@
+#pragma once
+
+// Compile-time profiler hooks around scheduling events, for Tracy, ITT, perf markers or a
+// recorder of your own. Set JOBKIT_PROFILER_HEADER (CMake option of the same name) to a header
+// that defines any of the macros below; the rest expand to nothing, as do all of them when no
+// header is given. The CMake option passes it on to everything linking jobkit: every translation
+// unit that includes JobSystemImpl.h must see the same hooks as the library.
+//
+//   JOBKIT_PROFILE_SUBMIT(label)            job accepted, on the submitting thread
+//   JOBKIT_PROFILE_JOB_BEGIN(label, worker) job about to run
+//   JOBKIT_PROFILE_JOB_END(label, worker)   job returned or threw
+//   JOBKIT_PROFILE_STEAL(thief, victim)     job taken from the front of another worker's queue
+//   JOBKIT_PROFILE_PARK(worker)             worker about to sleep for lack of work
+//   JOBKIT_PROFILE_UNPARK(worker)           worker woke up
+//
+// worker is the pool worker index, or ThreadPool::kNotAWorker for other threads. label is the
+// job's label name (const char*, may be null); jobs carry it to BEGIN/END only with
+// telemetry on (FullTelemetry, see TelemetrySettings) and show null otherwise. BEGIN/END pairs
+// nest when a waiting job runs others.
+// Hooks run on the scheduler's hot paths: keep them short, and never submit or wait from one.
+// PARK/UNPARK run with the pool's sleep lock held; the others with no scheduler lock held.
+
+#if defined(JOBKIT_PROFILER_HEADER)
+    #include JOBKIT_PROFILER_HEADER
+#endif
+
+#ifndef JOBKIT_PROFILE_SUBMIT
+    #define JOBKIT_PROFILE_SUBMIT(label) ((void)0)
+#endif
+#ifndef JOBKIT_PROFILE_JOB_BEGIN
+    #define JOBKIT_PROFILE_JOB_BEGIN(label, worker) ((void)0)
+#endif
+#ifndef JOBKIT_PROFILE_JOB_END
+    #define JOBKIT_PROFILE_JOB_END(label, worker) ((void)0)
+#endif
+#ifndef JOBKIT_PROFILE_STEAL
+    #define JOBKIT_PROFILE_STEAL(thief, victim) ((void)0)
+#endif
+#ifndef JOBKIT_PROFILE_PARK
+    #define JOBKIT_PROFILE_PARK(worker) ((void)0)
+#endif
+#ifndef JOBKIT_PROFILE_UNPARK
+    #define JOBKIT_PROFILE_UNPARK(worker) ((void)0)
+#endif
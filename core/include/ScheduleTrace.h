@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace core
+{
+    // One executed job as captured by JobSystem::StartRecording().
+    // All timestamps are nanoseconds relative to the start of the recording.
+    struct ScheduleRecord
+    {
+        uint64_t id = 0;
+        uint64_t parentId = 0;   // job that submitted this one, 0 = external thread
+        uint32_t labelIndex = 0; // index into ScheduleTrace::labels, 0 = unlabeled
+        uint32_t epoch = 0;      // number of WaitIdle() returns before submission
+        uint32_t worker = 0;
+
+        int64_t submitNs = 0;
+        int64_t startNs = 0;
+        int64_t durationNs = 0; // own run time, without time in waits (Wait, WaitIdle, Latch, ...)
+
+        std::vector<uint64_t> dependencies; // jobs that had to finish before this one
+    };
+
+    struct ScheduleTrace
+    {
+        uint32_t workerCount = 0;
+        std::vector<std::string> labels{std::string()}; // labels[0] is the unlabeled entry
+        std::vector<ScheduleRecord> records;            // sorted by id
+    };
+
+    // Compact binary (varint) encoding. Return false on I/O or format errors.
+    bool SaveScheduleTrace(const ScheduleTrace& trace, const char* path);
+    bool LoadScheduleTrace(const char* path, ScheduleTrace& out);
+
+    enum class SimPolicy : uint8_t
+    {
+        Fifo, // oldest ready job first (shared queue)
+        Lifo  // newest ready job first (owner-local stacks)
+    };
+
+    struct SimConfig
+    {
+        uint32_t workerCount = 1; // 0 = unbounded
+        SimPolicy policy = SimPolicy::Fifo;
+    };
+
+    struct SimResult
+    {
+        int64_t makespanNs = 0;
+        int64_t totalWorkNs = 0;
+        double utilization = 0.0; // totalWork / (workers * makespan)
+
+        // Chain of jobs (ids, first to last) that bounds the makespan under unbounded workers.
+        std::vector<uint64_t> criticalPath;
+        int64_t criticalPathNs = 0;
+    };
+
+    // Replays a recorded trace through a discrete-event model of the scheduler.
+    //
+    // A job becomes ready once all of its gates are met:
+    //  - spawned jobs: the parent has run for as long as it had when it submitted the child,
+    //  - external jobs: the previous epoch (WaitIdle) has drained, plus the recorded
+    //    serial gap on the submitting thread,
+    //  - every recorded dependency has finished.
+    SimResult SimulateSchedule(const ScheduleTrace& trace, const SimConfig& cfg);
+
+    struct CriticalPathReport
+    {
+        uint32_t epoch = 0;
+        uint64_t jobCount = 0;
+
+        int64_t totalWorkNs = 0; // sum of job durations
+        int64_t spanNs = 0;      // longest dependency chain, including serial submit gaps
+        double parallelism = 0.0; // totalWork / span: the speedup more workers could achieve
+
+        std::vector<uint64_t> path;      // job ids, first to last
+        std::vector<std::string> labels; // label of each job on the path ("" if unlabeled)
+    };
+
+    // Per-frame critical paths. A frame is one WaitIdle epoch: everything submitted between two
+    // WaitIdle() returns, including the jobs those spawned. Reports are ordered by epoch.
+    std::vector<CriticalPathReport> AnalyzeCriticalPaths(const ScheduleTrace& trace);
+} // namespace core
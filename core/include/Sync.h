@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "JobSystem.h"
+
+namespace core
+{
+    // Synchronization for use inside jobs. Latch and event waits run other queued jobs of the
+    // JobSystem while unsatisfied and only then park the thread on a futex (std::atomic::wait),
+    // so they never idle a worker that could make progress. Signalling is lock-free. The
+    // JobSystem must outlive the primitive.
+
+    // Single-use countdown, like std::latch.
+    class Latch
+    {
+    public:
+        Latch(JobSystemBase& js, uint32_t count);
+
+        Latch(const Latch&) = delete;
+        Latch& operator=(const Latch&) = delete;
+
+        void CountDown(uint32_t n = 1);
+        bool TryWait() const;
+        void Wait();
+        void ArriveAndWait(uint32_t n = 1);
+
+    private:
+        JobSystemBase& m_js;
+        std::atomic<uint32_t> m_count;
+    };
+
+    // Reusable barrier for a fixed number of participants, like std::barrier without a
+    // completion function. Unlike the others, ArriveAndWait parks without running other jobs:
+    // a helper could pick up another participant, which would then wait for the next phase on
+    // top of one that can no longer reach it. Participants must therefore all be able to run
+    // at once, on distinct workers or outside threads.
+    class Barrier
+    {
+    public:
+        explicit Barrier(uint32_t participants);
+
+        Barrier(const Barrier&) = delete;
+        Barrier& operator=(const Barrier&) = delete;
+
+        void ArriveAndWait();
+
+    private:
+        const uint32_t m_participants;
+        std::atomic<uint32_t> m_arrived{0};
+        std::atomic<uint32_t> m_phase{0};
+    };
+
+    // Stays signalled from Set until Reset; Wait returns immediately while set.
+    class ManualResetEvent
+    {
+    public:
+        explicit ManualResetEvent(JobSystemBase& js, bool initiallySet = false);
+
+        ManualResetEvent(const ManualResetEvent&) = delete;
+        ManualResetEvent& operator=(const ManualResetEvent&) = delete;
+
+        void Set();
+        void Reset();
+        bool IsSet() const;
+        void Wait();
+
+    private:
+        JobSystemBase& m_js;
+        std::atomic<bool> m_set;
+    };
+
+    // Mutex for state shared between jobs. On contention it spins briefly, then runs other
+    // queued jobs of the JobSystem, and parks on a futex only when there is nothing to run.
+    // Helping is limited to stay deadlock-free: a thread never helps while it holds a JobMutex
+    // or while it is already helping inside a JobMutex wait, since the job it picks up could
+    // need a lock that only the suspended job below it can release. For the same reason, do
+    // not Wait on jobs while holding one.
+    //
+    // Unlock lets running threads barge in, which avoids lock convoys. A waiter that has been
+    // passed over for longer than kStarvationNs switches the mutex to starvation mode: new
+    // arrivals then queue behind it until it gets the lock. It drops the claim while it runs
+    // another job, which may lock the mutex itself.
+    // Not recursive. lock/try_lock/unlock make it usable with std::lock_guard and friends.
+    class JobMutex
+    {
+    public:
+        explicit JobMutex(JobSystemBase& js);
+
+        JobMutex(const JobMutex&) = delete;
+        JobMutex& operator=(const JobMutex&) = delete;
+
+        void Lock();
+        bool TryLock();
+        void Unlock();
+
+        void lock() { Lock(); }
+        bool try_lock() { return TryLock(); }
+        void unlock() { Unlock(); }
+
+        static constexpr uint32_t kSpinCount = 64;
+        static constexpr int64_t kStarvationNs = 1'000'000;
+
+    private:
+        static constexpr uint32_t kLocked = 1;
+        static constexpr uint32_t kStarving = 2;
+
+        bool TryAcquire(bool starving);
+
+        JobSystemBase& m_js;
+        std::atomic<uint32_t> m_state{0};
+        std::atomic<uint32_t> m_waiters{0}; // threads parked on m_state
+    };
+} // namespace core
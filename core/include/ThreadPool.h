@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "Topology.h"
+
+namespace core
+{
+    class JobSystemBase;
+    class JobserverClient;
+
+    template <typename QueuePolicy, typename IdlePolicy, typename TelemetryPolicy, typename TaskStorage>
+    class JobSystemT;
+
+    // Worker threads shared by one or more JobSystem front-ends.
+    // Each front-end keeps its own queue, stats and WaitIdle/Stop semantics; the pool only owns
+    // the threads, wakes them on submission and round-robins them across attached front-ends.
+    // Front-ends hold a shared_ptr to the pool, so it outlives every JobSystem attached to it.
+    class ThreadPool
+    {
+    public:
+        // Scheduling class for the realtime worker group.
+        enum class RealtimePolicy : uint8_t
+        {
+            Fifo,       // SCHED_FIFO at realtimePriority
+            RoundRobin, // SCHED_RR at realtimePriority
+            Nice        // normal scheduling with the realtimeNice value
+        };
+
+        // How worker threads are created, and what runs on them around the job loop.
+        struct WorkerHooks
+        {
+            size_t stackSize = 0;            // bytes, 0 = platform default (8 MB on most Linux)
+            std::string namePrefix = "jobkit"; // threads are named "<prefix>-<index>" (Linux keeps 15 chars)
+
+            // Run on the worker thread itself: onStart before its first job (after pinning and
+            // scheduling class), onStop after its last. Typical use: thread-local allocators and
+            // profiler contexts. Called concurrently from different workers.
+            std::function<void(uint32_t workerIndex)> onStart;
+            std::function<void(uint32_t workerIndex)> onStop;
+        };
+
+        struct Config
+        {
+            uint32_t workerThreads = 0; // 0 = one per usable physical core, within the cgroup quota
+
+            // Pin worker i to the i-th CPU of PlanWorkerPlacement() (high-capacity cores first).
+            // Pinned workers on the biggest cores serve CoreHint::HighCapacity jobs first.
+            bool pinWorkers = false;
+
+            // Topology used for the default worker count and for pinning. Null = detect it with
+            // DetectCpuTopology(); supply one to plan for a known or simulated machine.
+            std::shared_ptr<const CpuTopology> topology;
+
+            // Idle workers steal from the nearest victims first: SMT sibling, then same L3, then
+            // same NUMA node, then remote (unpinned workers are all near). While work is queued
+            // only further away, a worker retries the near ones this many times, yielding in
+            // between, before reaching out; an owner or neighbour often gets there first.
+            uint32_t localStealAttempts = 2;
+
+            // Honor the GNU make jobserver advertised in MAKEFLAGS, if any: worker 0 runs on the
+            // process's implicit slot, every other worker holds a token while it runs jobs and
+            // returns it before going idle. Ignored when no jobserver is present.
+            bool useJobserver = false;
+
+            // Spawn workers on demand instead of in the constructor: the first submission starts
+            // one thread, and further threads start while the backlog outnumbers awake workers,
+            // up to workerThreads. Keeps launch cheap for short-lived tools.
+            bool lazyStart = false;
+
+            // Workers [0, realtimeWorkers) form a latency-critical group: they run under
+            // realtimePolicy, only execute Priority::Realtime jobs, start eagerly even with
+            // lazyStart and never hold jobserver tokens. Clamped so at least one ordinary worker
+            // remains. Raising the policy usually needs privileges (root, CAP_SYS_NICE or
+            // RLIMIT_RTPRIO); when refused the group still runs, at normal priority.
+            uint32_t realtimeWorkers = 0;
+            RealtimePolicy realtimePolicy = RealtimePolicy::Fifo;
+            int realtimePriority = 50; // 1..99 for Fifo/RoundRobin
+            int realtimeNice = -10;    // -20..19 for Nice
+
+            WorkerHooks hooks;
+        };
+
+    public:
+        ThreadPool();
+        explicit ThreadPool(const Config& cfg);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Configured worker count; with lazyStart, StartedWorkerCount() may be lower.
+        uint32_t WorkerCount() const { return m_workerCount; }
+        uint32_t StartedWorkerCount() const { return m_started.load(std::memory_order_acquire); }
+
+        // Detected when workerThreads == 0 or pinWorkers is set; empty otherwise.
+        const CpuTopology& Topology() const { return m_topology; }
+
+        // Unpinned workers may run anywhere and all count as high capacity.
+        bool IsHighCapacityWorker(uint32_t workerIndex) const
+        {
+            return workerIndex < m_highCapacity.size() && m_highCapacity[workerIndex] != 0;
+        }
+
+        // Index of the calling thread among this pool's workers, or kNotAWorker.
+        static constexpr uint32_t kNotAWorker = UINT32_MAX;
+        uint32_t CurrentWorkerIndex() const;
+
+        // Workers to steal from, nearest first; the first NearVictimCount() share the SMT core
+        // or L3 cache. Realtime workers never appear: they hold no stealable jobs.
+        std::span<const uint32_t> StealOrder(uint32_t workerIndex) const { return m_stealOrder[workerIndex]; }
+        uint32_t NearVictimCount(uint32_t workerIndex) const { return m_nearVictims[workerIndex]; }
+
+        uint32_t RealtimeWorkerCount() const { return m_realtimeCount; }
+        bool IsRealtimeWorker(uint32_t workerIndex) const { return workerIndex < m_realtimeCount; }
+
+        // Realtime workers whose scheduling policy was actually applied by the OS.
+        uint32_t RealtimeWorkersApplied() const { return m_realtimeApplied.load(std::memory_order_acquire); }
+
+        // True when useJobserver was requested and a jobserver was found.
+        bool UsesJobserver() const { return m_jobserver != nullptr; }
+
+        // Wakes a sleeping worker, if any. Front-ends call this after enqueueing work, passing
+        // their queue depth so lazily started pools know when to grow.
+        void NotifyOne(uint64_t backlog = 1);
+        void NotifyAll(uint64_t backlog = 0);
+
+        // Wakes a sleeping realtime worker for a Priority::Realtime job.
+        void NotifyRealtime();
+
+        // Cumulative idle-side counters of one worker, across every attached JobSystem. Kept
+        // while at least one attached system has telemetry on; they hold still otherwise.
+        struct WorkerCounters
+        {
+            uint64_t spinNs = 0;          // retrying near victims before stealing further
+            uint64_t parkedNs = 0;        // asleep waiting for work
+            uint64_t wakeups = 0;         // returns from sleep
+            uint64_t spuriousWakeups = 0; // ... after which there was nothing to run
+        };
+        WorkerCounters GetWorkerCounters(uint32_t workerIndex) const;
+
+    private:
+        friend class JobSystemBase;
+        template <typename Q, typename I, typename T, typename S>
+        friend class JobSystemT;
+
+        struct WorkerThread; // native thread + stop source; std::jthread cannot set a stack size
+
+        void Attach(JobSystemBase* js);
+        void Detach(JobSystemBase* js);
+
+        // Worker counters are kept while any front-end holds a reference (telemetry on).
+        void RetainCounters() { m_counterUsers.fetch_add(1, std::memory_order_relaxed); }
+        void ReleaseCounters() { m_counterUsers.fetch_sub(1, std::memory_order_relaxed); }
+
+        // Stops and joins all workers. Used by the destructor and by a JobSystem's Stop() for
+        // the private pool it owns.
+        void Shutdown();
+
+        void StartWorker(uint32_t index);
+        void StartWorkersFor(uint64_t backlog, uint32_t maxNew);
+        void WorkerMain(std::stop_token st, uint32_t workerIndex); // thread setup, hooks, loop
+        void WorkerLoop(std::stop_token st, uint32_t workerIndex);
+        bool HasQueuedWork() const;
+        void PlanStealOrder();
+
+    private:
+        Config m_cfg{};
+
+        // Attached front-ends. Workers hold the shared lock only while dequeuing, never while
+        // running a job, so a job may construct or stop other JobSystems on the same pool.
+        mutable std::shared_mutex m_frontMtx;
+        std::vector<JobSystemBase*> m_frontends;
+
+        std::mutex m_sleepMtx;
+        std::condition_variable m_cvWork;
+        std::atomic<uint64_t> m_signal{0};
+        std::atomic<uint32_t> m_sleepers{0};
+
+        // Realtime workers sleep apart so ordinary submissions never wake them.
+        std::condition_variable m_cvRealtime;
+        std::atomic<uint64_t> m_rtSignal{0};
+        std::atomic<uint32_t> m_rtSleepers{0};
+        uint32_t m_realtimeCount = 0;
+        std::atomic<uint32_t> m_realtimeApplied{0};
+
+        CpuTopology m_topology;
+        std::vector<uint32_t> m_workerCpu;    // pin target per worker (empty = unpinned)
+        std::vector<uint8_t> m_highCapacity;  // per worker
+        std::vector<std::vector<uint32_t>> m_stealOrder; // per worker
+        std::vector<uint32_t> m_nearVictims;             // per worker
+
+        std::unique_ptr<JobserverClient> m_jobserver;
+
+        // Written only by the owning worker; read by GetWorkerCounters.
+        struct alignas(64) WorkerCounterCells
+        {
+            std::atomic<uint64_t> spinNs{0};
+            std::atomic<uint64_t> parkedNs{0};
+            std::atomic<uint64_t> wakeups{0};
+            std::atomic<uint64_t> spuriousWakeups{0};
+        };
+        std::unique_ptr<WorkerCounterCells[]> m_counters;
+        std::atomic<uint32_t> m_counterUsers{0};
+
+        // Fixed-size slots so lazily started threads never reallocate under readers.
+        std::unique_ptr<WorkerThread[]> m_workers;
+        uint32_t m_workerCount = 0;
+        std::atomic<uint32_t> m_started{0};
+        std::mutex m_spawnMtx;
+        bool m_shutdown = false;
+    };
+} // namespace core
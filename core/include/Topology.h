@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace core
+{
+    // One logical CPU the process may run on.
+    struct CpuInfo
+    {
+        uint32_t cpu = 0;      // OS logical CPU number
+        uint32_t core = 0;     // physical core key (lowest logical CPU among its SMT siblings)
+        uint32_t l3 = 0;       // last-level cache domain key (lowest logical CPU sharing it)
+        uint32_t numaNode = 0;
+        uint32_t capacity = 1024; // relative compute capacity, 1024 = biggest core in the system
+        bool smtPrimary = true;   // first hardware thread of its core
+    };
+
+    // Usable CPUs of this process: online CPUs filtered by the affinity mask, annotated from
+    // /sys/devices/system/cpu (cpu_capacity, thread siblings, cache ids, NUMA nodes) and limited
+    // by the cgroup CPU quota. Platforms without sysfs get one flat core per hardware thread.
+    struct CpuTopology
+    {
+        std::vector<CpuInfo> cpus; // sorted by cpu
+        uint32_t physicalCores = 0;
+        uint32_t maxCapacity = 1024;
+        double cpuQuota = 0.0; // cgroup cpu.max / cfs quota in CPUs, 0 = unlimited
+
+        bool IsHighCapacity(const CpuInfo& c) const { return c.capacity >= maxCapacity; }
+    };
+
+    // Overridable inputs, so tests can point detection at a fake sysfs tree.
+    struct TopologySources
+    {
+        std::string sysRoot = "/sys";        // contains devices/system/cpu, devices/cpu_atom, fs/cgroup
+        std::string procSelfCgroup = "/proc/self/cgroup";
+        bool useAffinityMask = true;         // intersect with sched_getaffinity
+    };
+
+    CpuTopology DetectCpuTopology(const TopologySources& src = {});
+
+    // One worker per usable physical core, capped by the cgroup quota (rounded up), at least 1.
+    uint32_t DefaultWorkerCount(const CpuTopology& topo);
+
+    // CPU for each of `workers` workers: one thread per physical core before any SMT sibling,
+    // high-capacity cores first within each group. Wraps around when workers > CPUs.
+    std::vector<uint32_t> PlanWorkerPlacement(const CpuTopology& topo, uint32_t workers);
+
+    // Restricts the calling thread to one logical CPU. Returns false if unsupported or refused.
+    bool PinCurrentThreadToCpu(uint32_t cpu);
+} // namespace core
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace core
+{
+    // Samples a JobSystem's workers from its own thread at a low rate and reports jobs that run
+    // past their label's time budget, and ready jobs that have waited in the queues too long.
+    // A job is reported once, after two samples agree it is over budget; a job run nested in a
+    // waiting one is seen in its place while it runs. Takes any configuration; it sees only
+    // what the system's telemetry records (jobs with an id: all, or the sampled ones while
+    // sampling), and nothing while that is off. May keep sampling
+    // while the system stops and after, but must not outlive the JobSystem.
+    class StallWatchdog
+    {
+    public:
+        struct Stall
+        {
+            uint32_t workerIndex = 0;
+            uint64_t taskId = 0;
+            const char* label = nullptr;
+            int64_t runningNs = 0;
+            int64_t budgetNs = 0;
+        };
+
+        struct Config
+        {
+            std::chrono::milliseconds interval{50};
+
+            // Budgets by label text; other jobs get defaultBudgetNs. 0 = unlimited.
+            std::vector<std::pair<std::string, int64_t>> budgetsNs;
+            int64_t defaultBudgetNs = 100'000'000;
+
+            int64_t starvationNs = 100'000'000; // queue age that counts as starved; 0 = off
+
+            // Called on the watchdog thread. Null = log to stderr.
+            std::function<void(const Stall&)> onStall;
+            std::function<void(const JobSystemBase::QueueAges&)> onStarvation; // samples with starved jobs
+        };
+
+        StallWatchdog(const JobSystemBase& js, Config cfg);
+        ~StallWatchdog();
+
+        StallWatchdog(const StallWatchdog&) = delete;
+        StallWatchdog& operator=(const StallWatchdog&) = delete;
+
+        // One sample outside the schedule.
+        void SampleNow();
+
+        uint64_t StallCount() const { return m_stalls.load(std::memory_order_relaxed); }
+        uint64_t StarvedJobs() const { return m_starved.load(std::memory_order_relaxed); } // last sample
+
+    private:
+        struct Seen
+        {
+            uint64_t taskId = 0;
+            int64_t sinceNs = 0; // first sample's time if the job's start was not sampled
+            bool reported = false;
+        };
+
+        void Run(std::stop_token st);
+        int64_t BudgetFor(LabelId label);
+
+        const JobSystemBase& m_js;
+        const Config m_cfg;
+
+        std::mutex m_sampleMtx; // guards the state below
+        std::vector<Seen> m_seen; // per worker, from the previous sample
+        std::vector<int64_t> m_budgetCache; // by label id; -1 = not looked up yet
+
+        std::atomic<uint64_t> m_stalls{0};
+        std::atomic<uint64_t> m_starved{0};
+
+        std::mutex m_sleepMtx;
+        std::condition_variable_any m_cv;
+        std::jthread m_thread;
+    };
+} // namespace core
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace core
+{
+    // One instance of T per worker of a pool, plus one per outside thread that helps (e.g. a
+    // caller inside Wait). Local() never contends: each thread only touches its own
+    // cache-line-padded instance. Merge with ForEach/Combine once the jobs are done (after
+    // WaitIdle or Wait); neither synchronizes with threads still writing.
+    template <typename T>
+    class WorkerLocal
+    {
+    public:
+        explicit WorkerLocal(const JobSystemBase& js, const T& init = T{})
+            : WorkerLocal(js.Pool(), init)
+        {
+        }
+
+        explicit WorkerLocal(const ThreadPool& pool, const T& init = T{})
+            : m_pool(pool)
+            , m_init(init)
+            , m_workers(pool.WorkerCount(), Padded{init})
+            , m_id(NextId())
+        {
+        }
+
+        WorkerLocal(const WorkerLocal&) = delete;
+        WorkerLocal& operator=(const WorkerLocal&) = delete;
+
+        // The calling thread's instance. Pool workers index directly; outside threads get one
+        // on first use and remember it, so they only lock when switching between WorkerLocals.
+        T& Local()
+        {
+            const uint32_t index = m_pool.CurrentWorkerIndex();
+            if (index < m_workers.size())
+                return m_workers[index].value;
+
+            // Ids are never reused, so a stale entry cannot match a newer WorkerLocal.
+            static thread_local OutsideCache t_cache;
+            const uint64_t id = m_id.load(std::memory_order_acquire);
+            if (t_cache.id == id)
+                return *t_cache.value;
+
+            const std::thread::id self = std::this_thread::get_id();
+            std::lock_guard<std::mutex> lock(m_mtx);
+            T* value = nullptr;
+            for (Outside& o : m_outside)
+            {
+                if (o.thread == self)
+                    value = &o.slot.value;
+            }
+            if (!value)
+            {
+                m_outside.push_back(Outside{self, Padded{m_init}});
+                value = &m_outside.back().slot.value;
+            }
+            t_cache = OutsideCache{m_id.load(std::memory_order_relaxed), value};
+            return *value;
+        }
+
+        // Visits every instance, including untouched ones still equal to init.
+        template <typename F>
+        void ForEach(F&& fn)
+        {
+            for (Padded& p : m_workers)
+                fn(p.value);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            for (Outside& o : m_outside)
+                fn(o.slot.value);
+        }
+
+        // Folds all instances with op(acc, instance), starting from the first one, so init is
+        // counted once per instance and never on top of that. T{} when there are none (a pool
+        // without workers, before any outside thread called Local).
+        template <typename BinaryOp>
+        T Combine(BinaryOp&& op) const
+        {
+            T acc{};
+            bool first = true;
+            auto fold = [&](const T& value) {
+                acc = first ? value : op(std::move(acc), value);
+                first = false;
+            };
+            for (const Padded& p : m_workers)
+                fold(p.value);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            for (const Outside& o : m_outside)
+                fold(o.slot.value);
+            return acc;
+        }
+
+        // Resets every instance to init; outside threads' instances are dropped. Like ForEach,
+        // call it only once no job can still be in Local(): worker instances are overwritten
+        // in place, and a thread still holding a reference from Local() keeps writing to a
+        // dropped instance.
+        void Clear()
+        {
+            for (Padded& p : m_workers)
+                p.value = m_init;
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_outside.clear();
+            m_id.store(NextId(), std::memory_order_release); // forget cached outside instances
+        }
+
+    private:
+        struct alignas(64) Padded
+        {
+            T value;
+        };
+
+        struct Outside
+        {
+            std::thread::id thread;
+            Padded slot;
+        };
+
+        struct OutsideCache
+        {
+            uint64_t id = 0;
+            T* value = nullptr;
+        };
+
+        static uint64_t NextId()
+        {
+            static std::atomic<uint64_t> s_next{1};
+            return s_next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const ThreadPool& m_pool;
+        const T m_init;
+        std::vector<Padded> m_workers;
+        std::atomic<uint64_t> m_id; // identifies this instance set in outside threads' caches
+
+        mutable std::mutex m_mtx;
+        std::deque<Outside> m_outside; // stable addresses as threads are added
+    };
+} // namespace core
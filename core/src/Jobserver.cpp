@@ -0,0 +1,173 @@
+#include "Jobserver.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+namespace core
+{
+    static std::string FindAuth(const std::string& makeflags)
+    {
+        // make may list the option more than once; the last occurrence wins.
+        static const char* kOptions[] = {"--jobserver-auth=", "--jobserver-fds="};
+
+        size_t bestPos = std::string::npos;
+        size_t bestLen = 0;
+        for (const char* opt : kOptions)
+        {
+            const std::string o(opt);
+            const size_t pos = makeflags.rfind(o);
+            if (pos != std::string::npos && (bestPos == std::string::npos || pos > bestPos))
+            {
+                bestPos = pos;
+                bestLen = o.size();
+            }
+        }
+
+        if (bestPos == std::string::npos)
+            return std::string();
+
+        const size_t begin = bestPos + bestLen;
+        const size_t end = makeflags.find_first_of(" \t", begin);
+        return makeflags.substr(begin, (end == std::string::npos) ? std::string::npos : end - begin);
+    }
+
+    std::unique_ptr<JobserverClient> JobserverClient::FromEnvironment()
+    {
+        const char* flags = std::getenv("MAKEFLAGS");
+        if (!flags)
+            return nullptr;
+
+        const std::string auth = FindAuth(flags);
+        if (auth.empty())
+            return nullptr;
+
+        return FromAuth(auth);
+    }
+
+#if defined(_WIN32)
+
+    std::unique_ptr<JobserverClient> JobserverClient::FromAuth(const std::string& auth)
+    {
+        HANDLE sem = OpenSemaphoreA(SYNCHRONIZE | SEMAPHORE_MODIFY_STATE, FALSE, auth.c_str());
+        if (!sem)
+            return nullptr;
+
+        std::unique_ptr<JobserverClient> client(new JobserverClient());
+        client->m_semaphore = sem;
+        return client;
+    }
+
+    JobserverClient::~JobserverClient()
+    {
+        if (m_semaphore)
+            CloseHandle((HANDLE)m_semaphore);
+    }
+
+    bool JobserverClient::TryAcquire(uint32_t timeoutMs, char& token)
+    {
+        if (WaitForSingleObject((HANDLE)m_semaphore, timeoutMs) != WAIT_OBJECT_0)
+            return false;
+
+        token = '+';
+        return true;
+    }
+
+    void JobserverClient::Release(char token)
+    {
+        (void)token;
+        ReleaseSemaphore((HANDLE)m_semaphore, 1, nullptr);
+    }
+
+#else
+
+    std::unique_ptr<JobserverClient> JobserverClient::FromAuth(const std::string& auth)
+    {
+        std::unique_ptr<JobserverClient> client(new JobserverClient());
+
+        if (auth.rfind("fifo:", 0) == 0)
+        {
+            // Our own open file description, so O_NONBLOCK does not leak to other processes.
+            const int fd = ::open(auth.c_str() + 5, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0)
+                return nullptr;
+
+            client->m_readFd = fd;
+            client->m_writeFd = fd;
+            client->m_ownsReadFd = true;
+            return client;
+        }
+
+        const size_t comma = auth.find(',');
+        if (comma == std::string::npos)
+            return nullptr;
+
+        char* end = nullptr;
+        const long r = std::strtol(auth.c_str(), &end, 10);
+        if (end != auth.c_str() + comma)
+            return nullptr;
+        const long w = std::strtol(auth.c_str() + comma + 1, &end, 10);
+        if (*end != '\0' || r < 0 || w < 0)
+            return nullptr;
+
+        // make closes the fds for commands it does not consider recursive ('+' prefix).
+        if (::fcntl((int)r, F_GETFD) == -1 || ::fcntl((int)w, F_GETFD) == -1)
+            return nullptr;
+
+        // The inherited pipe is shared with make and its other children, so O_NONBLOCK must not
+        // be set on it. Reopening through /proc gives us a private open file description.
+        const std::string procPath = "/proc/self/fd/" + std::to_string(r);
+        const int privateFd = ::open(procPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+
+        client->m_readFd = (privateFd >= 0) ? privateFd : (int)r;
+        client->m_writeFd = (int)w;
+        client->m_ownsReadFd = (privateFd >= 0);
+        return client;
+    }
+
+    JobserverClient::~JobserverClient()
+    {
+        if (m_ownsReadFd && m_readFd >= 0)
+            ::close(m_readFd);
+    }
+
+    bool JobserverClient::TryAcquire(uint32_t timeoutMs, char& token)
+    {
+        pollfd pfd{};
+        pfd.fd = m_readFd;
+        pfd.events = POLLIN;
+
+        const int ready = ::poll(&pfd, 1, (int)timeoutMs);
+        if (ready <= 0 || (pfd.revents & POLLIN) == 0)
+            return false;
+
+        // Another process may take the token between poll and read: EAGAIN is just a miss.
+        // (Without a private descriptor the read can block until a token is released.)
+        char c = 0;
+        if (::read(m_readFd, &c, 1) != 1)
+            return false;
+
+        token = c;
+        return true;
+    }
+
+    void JobserverClient::Release(char token)
+    {
+        while (::write(m_writeFd, &token, 1) == -1 && errno == EINTR)
+        {
+        }
+    }
+
+#endif
+} // namespace core
@@ -0,0 +1,103 @@
+#include "Labels.h"
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace core
+{
+    namespace
+    {
+        struct Registry
+        {
+            Registry()
+            {
+                Add("(other)");
+            }
+
+            LabelId Add(std::string_view text) // mtx held (or construction)
+            {
+                const uint32_t id = count.load(std::memory_order_relaxed);
+                const std::string& stored = storage.emplace_back(text);
+                byText.emplace(stored, (LabelId)id);
+                names[id].store(stored.c_str(), std::memory_order_release);
+                count.store(id + 1, std::memory_order_release);
+                return (LabelId)id;
+            }
+
+            std::shared_mutex mtx;
+            std::deque<std::string> storage; // never moves its strings
+            std::unordered_map<std::string_view, LabelId> byText;
+            std::atomic<const char*> names[LabelRegistry::kMaxLabels]{};
+            std::atomic<uint32_t> count{1}; // 0 is kNone
+        };
+
+        Registry& Instance()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        // Per-thread pointer -> id cache, direct-mapped. Skips the hash lookup and its lock.
+        struct CacheEntry
+        {
+            const char* name = nullptr;
+            LabelId id = LabelRegistry::kNone;
+        };
+        constexpr uint32_t kCacheEntries = 64;
+        thread_local CacheEntry t_cache[kCacheEntries];
+    } // namespace
+
+    LabelId LabelRegistry::Intern(const char* name)
+    {
+        if (!name || name[0] == '\0')
+            return kNone;
+
+        // A hit is checked against the interned text, as the caller may have reused the buffer.
+        // (other) never hits: its text is not the caller's.
+        CacheEntry& cached = t_cache[(((uintptr_t)name >> 3) * 0x9E3779B97F4A7C15ull >> 32) % kCacheEntries];
+        if (cached.name == name && cached.id != kOther && std::strcmp(Name(cached.id), name) == 0)
+            return cached.id;
+
+        Registry& r = Instance();
+        const std::string_view text(name, std::strlen(name));
+        LabelId id = kNone;
+        {
+            std::shared_lock<std::shared_mutex> lock(r.mtx);
+            auto it = r.byText.find(text);
+            if (it != r.byText.end())
+                id = it->second;
+        }
+        if (id == kNone)
+        {
+            std::unique_lock<std::shared_mutex> lock(r.mtx);
+            auto it = r.byText.find(text);
+            if (it != r.byText.end())
+                id = it->second;
+            else if (r.count.load(std::memory_order_relaxed) < kMaxLabels)
+                id = r.Add(text);
+            else
+                id = kOther;
+        }
+
+        cached = CacheEntry{name, id};
+        return id;
+    }
+
+    const char* LabelRegistry::Name(LabelId id)
+    {
+        if (id == kNone || id >= kMaxLabels)
+            return nullptr;
+        return Instance().names[id].load(std::memory_order_acquire);
+    }
+
+    uint32_t LabelRegistry::Count()
+    {
+        return Instance().count.load(std::memory_order_acquire);
+    }
+} // namespace core
@@ -0,0 +1,230 @@
+#include "Metrics.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+namespace core
+{
+    namespace
+    {
+        // Writes one metric family: its metadata, then samples through Sample().
+        class Writer
+        {
+        public:
+            Writer(std::string& out, const MetricsOptions& opts)
+                : m_out(out)
+                , m_opts(opts)
+            {
+                if (!m_opts.system.empty())
+                    m_common = "system=\"" + Escape(m_opts.system) + "\"";
+            }
+
+            void Family(const char* name, const char* type, const char* help)
+            {
+                m_name = m_opts.prefix + "_" + name;
+                m_out += "# TYPE " + m_name + " " + type + "\n";
+                m_out += "# HELP " + m_name + " " + help + "\n";
+            }
+
+            // labels: pre-rendered name="value" pairs, or empty.
+            void Sample(const char* suffix, const std::string& labels, uint64_t value)
+            {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+                Line(suffix, labels, buf);
+            }
+
+            void SampleSeconds(const char* suffix, const std::string& labels, uint64_t ns)
+            {
+                char buf[48];
+                std::snprintf(buf, sizeof(buf), "%.9f", (double)ns / 1e9);
+                Line(suffix, labels, buf);
+            }
+
+            static std::string Escape(const std::string& v)
+            {
+                std::string e;
+                e.reserve(v.size());
+                for (char c : v)
+                {
+                    if (c == '\\' || c == '"')
+                    {
+                        e += '\\';
+                        e += c;
+                    }
+                    else if (c == '\n')
+                        e += "\\n";
+                    else
+                        e += c;
+                }
+                return e;
+            }
+
+        private:
+            void Line(const char* suffix, const std::string& labels, const char* value)
+            {
+                m_out += m_name;
+                m_out += suffix;
+                if (!m_common.empty() || !labels.empty())
+                {
+                    m_out += '{';
+                    m_out += m_common;
+                    if (!m_common.empty() && !labels.empty())
+                        m_out += ',';
+                    m_out += labels;
+                    m_out += '}';
+                }
+                m_out += ' ';
+                m_out += value;
+                m_out += '\n';
+            }
+
+            std::string& m_out;
+            const MetricsOptions& m_opts;
+            std::string m_common;
+            std::string m_name;
+        };
+
+        // Temporary file next to path, then rename, so readers never see a partial file.
+        bool WriteTextfile(const std::string& text, const char* path)
+        {
+            const std::string tmp = std::string(path) + ".tmp";
+
+            FILE* f = std::fopen(tmp.c_str(), "wb");
+            if (!f)
+                return false;
+
+            const bool written = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+            const bool closed = std::fclose(f) == 0;
+
+            std::error_code ec;
+            if (written && closed)
+                std::filesystem::rename(tmp, path, ec); // replaces path in one step
+            if (!written || !closed || ec)
+            {
+                std::filesystem::remove(tmp, ec);
+                return false;
+            }
+            return true;
+        }
+    } // namespace
+
+    std::string RenderOpenMetrics(const JobSystemBase& js, const MetricsOptions& opts)
+    {
+        std::string out;
+        Writer w(out, opts);
+
+        const JobSystemBase::Stats s = js.GetStats();
+        w.Family("workers", "gauge", "Worker threads of the pool.");
+        w.Sample("", "", s.workerCount);
+        w.Family("workers_started", "gauge", "Worker threads started so far (lazy start).");
+        w.Sample("", "", s.startedWorkers);
+        w.Family("paused", "gauge", "1 while the system is paused.");
+        w.Sample("", "", s.paused ? 1 : 0);
+        w.Family("jobs_queued", "gauge", "Jobs ready to run.");
+        w.Sample("", "", s.queued);
+        w.Family("jobs_waiting", "gauge", "Jobs held back by unfinished dependencies.");
+        w.Sample("", "", s.waiting);
+        w.Family("jobs_in_flight", "gauge", "Jobs taken by a thread and not yet finished.");
+        w.Sample("", "", s.inFlight);
+        w.Family("jobs_submitted", "counter", "Jobs accepted by Submit.");
+        w.Sample("_total", "", s.submitted);
+        w.Family("jobs_completed", "counter", "Jobs that finished running.");
+        w.Sample("_total", "", s.completed);
+
+        // Worker and label families stay empty without telemetry data.
+        const JobSystemBase::TelemetrySettings telemetry = js.GetTelemetry();
+        w.Family("telemetry_sample_every", "gauge", "Jobs per timed sample; 0 = telemetry off.");
+        w.Sample("", "", telemetry.enabled ? telemetry.sampleEvery : 0);
+
+        const std::vector<JobSystemBase::Diagnostics::Worker> workers = js.GetWorkerDiagnostics();
+        std::vector<std::string> workerLabels;
+        workerLabels.reserve(workers.size());
+        for (const JobSystemBase::Diagnostics::Worker& wk : workers)
+            workerLabels.push_back("worker=\"" + std::to_string(wk.workerIndex) + "\"");
+
+        auto perWorker = [&](const char* name, const char* help, bool seconds, auto field) {
+            w.Family(name, "counter", help);
+            for (size_t i = 0; i < workers.size(); ++i)
+            {
+                if (seconds)
+                    w.SampleSeconds("_total", workerLabels[i], workers[i].*field);
+                else
+                    w.Sample("_total", workerLabels[i], workers[i].*field);
+            }
+        };
+        using Worker = JobSystemBase::Diagnostics::Worker;
+        perWorker("worker_busy_seconds", "Time in outermost jobs.", true, &Worker::busyNs);
+        perWorker("worker_jobs", "Jobs run, nested ones included.", false, &Worker::jobsExecuted);
+        perWorker("worker_steals", "Jobs taken from other workers' local queues.", false, &Worker::steals);
+        perWorker("worker_failed_steals", "Passes over the victims that found nothing.", false, &Worker::failedSteals);
+        perWorker("worker_spin_seconds", "Time spinning for work before parking.", true, &Worker::spinNs);
+        perWorker("worker_parked_seconds", "Time parked.", true, &Worker::parkedNs);
+        perWorker("worker_wakeups", "Returns from parking.", false, &Worker::wakeups);
+        perWorker("worker_spurious_wakeups", "Wakeups that found nothing to run.", false, &Worker::spuriousWakeups);
+
+        const std::vector<JobSystemBase::LabelHistogram> histograms = js.GetLabelHistograms();
+        w.Family("job_duration_seconds", "histogram", "Own run time of labelled jobs.");
+        for (const JobSystemBase::LabelHistogram& h : histograms)
+        {
+            const std::string label = "label=\"" + Writer::Escape(h.label) + "\"";
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < JobSystemBase::kLabelHistogramBuckets; ++b)
+            {
+                cumulative += h.buckets[b];
+                char le[32] = "+Inf";
+                if (b + 1 < JobSystemBase::kLabelHistogramBuckets)
+                    std::snprintf(le, sizeof(le), "%g", (double)JobSystemBase::kLabelHistogramBoundsNs[b] / 1e9);
+                w.Sample("_bucket", label + ",le=\"" + le + "\"", cumulative);
+            }
+            w.SampleSeconds("_sum", label, h.sumNs);
+            w.Sample("_count", label, h.count);
+        }
+
+        out += "# EOF\n";
+        return out;
+    }
+
+    bool WriteOpenMetricsFile(const JobSystemBase& js, const char* path, const MetricsOptions& opts)
+    {
+        return WriteTextfile(RenderOpenMetrics(js, opts), path);
+    }
+
+    MetricsExporter::MetricsExporter(const JobSystemBase& js, Config cfg)
+        : m_js(js)
+        , m_cfg(std::move(cfg))
+    {
+        m_thread = std::jthread([this](std::stop_token st) { Run(st); });
+    }
+
+    MetricsExporter::~MetricsExporter()
+    {
+        m_thread.request_stop(); // wakes the interval wait
+        m_thread.join();
+    }
+
+    bool MetricsExporter::ExportNow()
+    {
+        std::lock_guard<std::mutex> lock(m_exportMtx);
+        const std::string text = RenderOpenMetrics(m_js, m_cfg.format);
+        if (m_cfg.callback)
+            m_cfg.callback(text);
+        return m_cfg.textfilePath.empty() || WriteTextfile(text, m_cfg.textfilePath.c_str());
+    }
+
+    void MetricsExporter::Run(std::stop_token st)
+    {
+        std::unique_lock<std::mutex> lock(m_sleepMtx);
+        while (!st.stop_requested())
+        {
+            m_cv.wait_for(lock, st, m_cfg.interval, [] { return false; }); // stop wakes it early
+            if (st.stop_requested())
+                break;
+
+            lock.unlock();
+            ExportNow();
+            lock.lock();
+        }
+    }
+} // namespace core
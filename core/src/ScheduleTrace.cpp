@@ -0,0 +1,465 @@
+#include "ScheduleTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <queue>
+#include <unordered_map>
+
+namespace core
+{
+    static constexpr char kTraceMagic[4] = {'J', 'K', 'S', 'T'};
+    static constexpr uint64_t kTraceVersion = 1;
+
+    // ---------------------------------------------------------------------
+    // Encoding: LEB128 varints, ids delta-coded against the previous record.
+    // ---------------------------------------------------------------------
+
+    static void PutVarint(std::vector<uint8_t>& out, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    static void PutSigned(std::vector<uint8_t>& out, int64_t v)
+    {
+        PutVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63)); // zigzag
+    }
+
+    struct Reader
+    {
+        const uint8_t* p = nullptr;
+        const uint8_t* end = nullptr;
+        bool ok = true;
+
+        uint64_t Varint()
+        {
+            uint64_t v = 0;
+            for (uint32_t shift = 0; shift < 64; shift += 7)
+            {
+                if (p == end)
+                    break;
+
+                const uint8_t b = *p++;
+                v |= (uint64_t)(b & 0x7f) << shift;
+                if ((b & 0x80) == 0)
+                    return v;
+            }
+            ok = false;
+            return 0;
+        }
+
+        int64_t Signed()
+        {
+            const uint64_t v = Varint();
+            return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+        }
+    };
+
+    bool SaveScheduleTrace(const ScheduleTrace& trace, const char* path)
+    {
+        std::vector<uint8_t> buf;
+        buf.insert(buf.end(), kTraceMagic, kTraceMagic + 4);
+        PutVarint(buf, kTraceVersion);
+        PutVarint(buf, trace.workerCount);
+
+        PutVarint(buf, trace.labels.size());
+        for (const std::string& l : trace.labels)
+        {
+            PutVarint(buf, l.size());
+            buf.insert(buf.end(), l.begin(), l.end());
+        }
+
+        PutVarint(buf, trace.records.size());
+        uint64_t prevId = 0;
+        for (const ScheduleRecord& r : trace.records)
+        {
+            PutSigned(buf, (int64_t)(r.id - prevId));
+            PutVarint(buf, r.parentId == 0 ? 0 : (r.id - r.parentId) + 1);
+            PutVarint(buf, r.labelIndex);
+            PutVarint(buf, r.epoch);
+            PutVarint(buf, r.worker);
+            PutSigned(buf, r.submitNs);
+            PutSigned(buf, r.startNs - r.submitNs);
+            PutSigned(buf, r.durationNs);
+
+            PutVarint(buf, r.dependencies.size());
+            for (uint64_t dep : r.dependencies)
+                PutSigned(buf, (int64_t)(r.id - dep));
+
+            prevId = r.id;
+        }
+
+        FILE* f = std::fopen(path, "wb");
+        if (!f)
+            return false;
+
+        const bool written = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+        const bool closed = std::fclose(f) == 0;
+        return written && closed;
+    }
+
+    bool LoadScheduleTrace(const char* path, ScheduleTrace& out)
+    {
+        FILE* f = std::fopen(path, "rb");
+        if (!f)
+            return false;
+
+        std::vector<uint8_t> buf;
+        uint8_t chunk[4096];
+        size_t n = 0;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+            buf.insert(buf.end(), chunk, chunk + n);
+        std::fclose(f);
+
+        if (buf.size() < 4 || !std::equal(kTraceMagic, kTraceMagic + 4, buf.begin()))
+            return false;
+
+        Reader rd{buf.data() + 4, buf.data() + buf.size()};
+        if (rd.Varint() != kTraceVersion)
+            return false;
+
+        ScheduleTrace t{};
+        t.workerCount = (uint32_t)rd.Varint();
+
+        const uint64_t labelCount = rd.Varint();
+        t.labels.clear();
+        for (uint64_t i = 0; i < labelCount && rd.ok; ++i)
+        {
+            const uint64_t len = rd.Varint();
+            if (len > (uint64_t)(rd.end - rd.p))
+                return false;
+            t.labels.emplace_back((const char*)rd.p, (size_t)len);
+            rd.p += len;
+        }
+
+        const uint64_t recordCount = rd.Varint();
+        if (!rd.ok || recordCount > (uint64_t)(rd.end - rd.p))
+            return false;
+
+        t.records.resize((size_t)recordCount);
+        uint64_t prevId = 0;
+        for (ScheduleRecord& r : t.records)
+        {
+            r.id = prevId + (uint64_t)rd.Signed();
+            const uint64_t parentDelta = rd.Varint();
+            r.parentId = parentDelta == 0 ? 0 : r.id - (parentDelta - 1);
+            r.labelIndex = (uint32_t)rd.Varint();
+            r.epoch = (uint32_t)rd.Varint();
+            r.worker = (uint32_t)rd.Varint();
+            r.submitNs = rd.Signed();
+            r.startNs = r.submitNs + rd.Signed();
+            r.durationNs = rd.Signed();
+
+            const uint64_t depCount = rd.Varint();
+            if (!rd.ok || depCount > (uint64_t)(rd.end - rd.p))
+                return false;
+            r.dependencies.resize((size_t)depCount);
+            for (uint64_t& dep : r.dependencies)
+                dep = r.id - (uint64_t)rd.Signed();
+
+            if (!rd.ok || r.labelIndex >= t.labels.size())
+                return false;
+            prevId = r.id;
+        }
+
+        if (!rd.ok || t.labels.empty())
+            return false;
+
+        out = std::move(t);
+        return true;
+    }
+
+    // ---------------------------------------------------------------------
+    // Discrete-event replay
+    // ---------------------------------------------------------------------
+
+    namespace
+    {
+        struct SimJob
+        {
+            int64_t durationNs = 0;
+            int64_t releaseOffsetNs = 0; // after parent start, or after epoch drain for roots
+
+            int32_t parent = -1;
+            uint32_t epochSlot = 0;
+
+            std::vector<int32_t> children;
+            std::vector<int32_t> dependents;
+
+            uint32_t gates = 0;
+            int64_t releaseNs = 0;
+            int32_t binding = -1; // predecessor that set releaseNs
+
+            int64_t finishNs = 0;
+        };
+
+        struct SimGraph
+        {
+            std::vector<SimJob> jobs;
+            std::vector<std::vector<int32_t>> epochRoots;
+            std::vector<uint32_t> epochSize;
+        };
+
+        SimGraph BuildGraph(const ScheduleTrace& trace)
+        {
+            SimGraph g{};
+            const size_t n = trace.records.size();
+            g.jobs.resize(n);
+
+            std::unordered_map<uint64_t, int32_t> byId;
+            byId.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                byId.emplace(trace.records[i].id, (int32_t)i);
+
+            std::map<uint32_t, uint32_t> epochSlots;
+            for (const ScheduleRecord& r : trace.records)
+                epochSlots.emplace(r.epoch, 0);
+
+            uint32_t slot = 0;
+            for (auto& [epoch, s] : epochSlots)
+                s = slot++;
+
+            g.epochRoots.resize(slot);
+            g.epochSize.resize(slot);
+
+            // Recorded time at which each epoch fully drained.
+            std::vector<int64_t> epochEnd(slot, 0);
+            for (const ScheduleRecord& r : trace.records)
+            {
+                const uint32_t s = epochSlots[r.epoch];
+                epochEnd[s] = std::max(epochEnd[s], r.startNs + r.durationNs);
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                const ScheduleRecord& r = trace.records[i];
+                SimJob& j = g.jobs[i];
+                j.durationNs = std::max<int64_t>(0, r.durationNs);
+                j.epochSlot = epochSlots[r.epoch];
+                ++g.epochSize[j.epochSlot];
+
+                auto parentIt = (r.parentId != 0) ? byId.find(r.parentId) : byId.end();
+                if (parentIt != byId.end())
+                {
+                    const ScheduleRecord& p = trace.records[(size_t)parentIt->second];
+                    j.parent = parentIt->second;
+                    j.releaseOffsetNs = std::clamp<int64_t>(r.submitNs - p.startNs, 0, std::max<int64_t>(0, p.durationNs));
+                    g.jobs[(size_t)j.parent].children.push_back((int32_t)i);
+                }
+                else
+                {
+                    const int64_t origin = (j.epochSlot == 0) ? 0 : epochEnd[j.epochSlot - 1];
+                    j.releaseOffsetNs = std::max<int64_t>(0, r.submitNs - origin);
+                    g.epochRoots[j.epochSlot].push_back((int32_t)i);
+                }
+                ++j.gates;
+
+                for (uint64_t dep : r.dependencies)
+                {
+                    auto depIt = byId.find(dep);
+                    if (depIt == byId.end() || depIt->second == (int32_t)i)
+                        continue;
+                    g.jobs[(size_t)depIt->second].dependents.push_back((int32_t)i);
+                    ++j.gates;
+                }
+            }
+
+            return g;
+        }
+
+        struct EngineResult
+        {
+            int64_t makespanNs = 0;
+            int32_t last = -1;
+        };
+
+        // Runs the list-scheduling model over g (mutated in place).
+        EngineResult RunEngine(SimGraph& g, uint32_t workerCount, SimPolicy policy)
+        {
+            using Entry = std::pair<int64_t, int32_t>; // (time, job)
+
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pending;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> running;
+
+            // Ready jobs keyed by release time; Fifo pops the oldest, Lifo the newest.
+            std::priority_queue<Entry, std::vector<Entry>, std::function<bool(const Entry&, const Entry&)>> ready(
+                [policy](const Entry& a, const Entry& b) {
+                    return (policy == SimPolicy::Fifo) ? (a > b) : (a < b);
+                });
+
+            auto resolve = [&](int32_t idx, int64_t t, int32_t pred) {
+                SimJob& j = g.jobs[(size_t)idx];
+                if (t >= j.releaseNs)
+                {
+                    j.releaseNs = t;
+                    j.binding = pred;
+                }
+                if (--j.gates == 0)
+                    pending.push({j.releaseNs, idx});
+            };
+
+            std::vector<uint32_t> epochLeft = g.epochSize;
+            if (!g.epochRoots.empty())
+            {
+                for (int32_t r : g.epochRoots[0])
+                    resolve(r, g.jobs[(size_t)r].releaseOffsetNs, -1);
+            }
+
+            const bool unbounded = (workerCount == 0);
+            uint64_t freeWorkers = unbounded ? g.jobs.size() : workerCount;
+
+            EngineResult res{};
+            size_t done = 0;
+            int64_t now = 0;
+
+            while (done < g.jobs.size())
+            {
+                while (!pending.empty() && pending.top().first <= now)
+                {
+                    ready.push(pending.top());
+                    pending.pop();
+                }
+
+                if (freeWorkers > 0 && !ready.empty())
+                {
+                    const int32_t idx = ready.top().second;
+                    ready.pop();
+                    --freeWorkers;
+
+                    SimJob& j = g.jobs[(size_t)idx];
+                    j.finishNs = now + j.durationNs;
+                    running.push({j.finishNs, idx});
+
+                    for (int32_t c : j.children)
+                        resolve(c, now + g.jobs[(size_t)c].releaseOffsetNs, idx);
+                    continue; // children may be ready at `now`
+                }
+
+                int64_t next = INT64_MAX;
+                if (!pending.empty())
+                    next = pending.top().first;
+                if (!running.empty())
+                    next = std::min(next, running.top().first);
+                if (next == INT64_MAX)
+                    break; // remaining jobs wait on gates that never resolve
+
+                now = std::max(now, next);
+
+                while (!running.empty() && running.top().first <= now)
+                {
+                    const int32_t idx = running.top().second;
+                    running.pop();
+                    ++freeWorkers;
+                    ++done;
+
+                    const SimJob& j = g.jobs[(size_t)idx];
+                    if (j.finishNs >= res.makespanNs)
+                    {
+                        res.makespanNs = j.finishNs;
+                        res.last = idx;
+                    }
+
+                    for (int32_t d : j.dependents)
+                        resolve(d, j.finishNs, idx);
+
+                    if (--epochLeft[j.epochSlot] == 0 && j.epochSlot + 1 < g.epochRoots.size())
+                    {
+                        for (int32_t r : g.epochRoots[j.epochSlot + 1])
+                            resolve(r, j.finishNs + g.jobs[(size_t)r].releaseOffsetNs, idx);
+                    }
+                }
+            }
+
+            return res;
+        }
+    } // namespace
+
+    SimResult SimulateSchedule(const ScheduleTrace& trace, const SimConfig& cfg)
+    {
+        SimResult out{};
+        if (trace.records.empty())
+            return out;
+
+        for (const ScheduleRecord& r : trace.records)
+            out.totalWorkNs += std::max<int64_t>(0, r.durationNs);
+
+        SimGraph g = BuildGraph(trace);
+        const SimGraph pristine = g;
+
+        const EngineResult run = RunEngine(g, cfg.workerCount, cfg.policy);
+        out.makespanNs = run.makespanNs;
+
+        const uint64_t workers = (cfg.workerCount == 0) ? trace.records.size() : cfg.workerCount;
+        if (out.makespanNs > 0)
+            out.utilization = (double)out.totalWorkNs / ((double)workers * (double)out.makespanNs);
+
+        // The critical path is the binding chain of an unbounded-worker replay.
+        SimGraph span = (cfg.workerCount == 0) ? std::move(g) : pristine;
+        const EngineResult spanRun = (cfg.workerCount == 0) ? run : RunEngine(span, 0, cfg.policy);
+        out.criticalPathNs = spanRun.makespanNs;
+
+        for (int32_t idx = spanRun.last; idx >= 0; idx = span.jobs[(size_t)idx].binding)
+            out.criticalPath.push_back(trace.records[(size_t)idx].id);
+        std::reverse(out.criticalPath.begin(), out.criticalPath.end());
+
+        return out;
+    }
+
+    std::vector<CriticalPathReport> AnalyzeCriticalPaths(const ScheduleTrace& trace)
+    {
+        std::map<uint32_t, ScheduleTrace> frames;
+        for (const ScheduleRecord& r : trace.records)
+        {
+            ScheduleTrace& f = frames[r.epoch];
+            f.records.push_back(r);
+            f.records.back().epoch = 0;
+        }
+
+        std::vector<CriticalPathReport> reports;
+        reports.reserve(frames.size());
+
+        for (auto& [epoch, frame] : frames)
+        {
+            // Measure the frame from its first submission, not from the start of the recording.
+            int64_t origin = INT64_MAX;
+            for (const ScheduleRecord& r : frame.records)
+                origin = std::min(origin, r.submitNs);
+            for (ScheduleRecord& r : frame.records)
+            {
+                r.submitNs -= origin;
+                r.startNs -= origin;
+            }
+
+            SimConfig cfg{};
+            cfg.workerCount = 0;
+            const SimResult sim = SimulateSchedule(frame, cfg);
+
+            CriticalPathReport rep{};
+            rep.epoch = epoch;
+            rep.jobCount = frame.records.size();
+            rep.totalWorkNs = sim.totalWorkNs;
+            rep.spanNs = sim.criticalPathNs;
+            rep.parallelism = (rep.spanNs > 0) ? (double)rep.totalWorkNs / (double)rep.spanNs : 0.0;
+            rep.path = sim.criticalPath;
+
+            std::unordered_map<uint64_t, uint32_t> labelOf;
+            for (const ScheduleRecord& r : frame.records)
+                labelOf.emplace(r.id, r.labelIndex);
+            for (uint64_t id : rep.path)
+            {
+                const uint32_t li = labelOf[id];
+                rep.labels.push_back(li < trace.labels.size() ? trace.labels[li] : std::string());
+            }
+
+            reports.push_back(std::move(rep));
+        }
+
+        return reports;
+    }
+} // namespace core
@@ -0,0 +1,208 @@
+#include "Sync.h"
+
+#include <chrono>
+#include <thread>
+
+namespace core
+{
+    namespace
+    {
+        // JobMutexes held by this thread, and whether it is running jobs from a JobMutex wait.
+        thread_local uint32_t t_jobMutexesHeld = 0;
+        thread_local bool t_helpingForMutex = false;
+
+        int64_t NowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    } // namespace
+
+    // Latch and event state is read and written seq_cst so that it orders against the parking
+    // handshake in JobSystemBase::HelpUntil / WakeHelpers.
+
+    Latch::Latch(JobSystemBase& js, uint32_t count)
+        : m_js(js)
+        , m_count(count)
+    {
+    }
+
+    void Latch::CountDown(uint32_t n)
+    {
+        if (m_count.fetch_sub(n, std::memory_order_seq_cst) == n)
+            m_js.WakeHelpers();
+    }
+
+    bool Latch::TryWait() const
+    {
+        return m_count.load(std::memory_order_seq_cst) == 0;
+    }
+
+    void Latch::Wait()
+    {
+        m_js.HelpUntil([this] { return TryWait(); });
+    }
+
+    void Latch::ArriveAndWait(uint32_t n)
+    {
+        CountDown(n);
+        Wait();
+    }
+
+    Barrier::Barrier(uint32_t participants)
+        : m_participants(participants)
+    {
+    }
+
+    void Barrier::ArriveAndWait()
+    {
+        const uint32_t phase = m_phase.load(std::memory_order_seq_cst);
+        if (m_arrived.fetch_add(1, std::memory_order_seq_cst) + 1 == m_participants)
+        {
+            // Last to arrive: reset for the next phase before releasing this one.
+            m_arrived.store(0, std::memory_order_seq_cst);
+            m_phase.fetch_add(1, std::memory_order_seq_cst);
+            m_phase.notify_all();
+            return;
+        }
+
+        // No helping (see Sync.h): park on the phase word until the last arrival bumps it.
+        const detail::WaitTimer timer;
+        while (m_phase.load(std::memory_order_seq_cst) == phase)
+            m_phase.wait(phase, std::memory_order_seq_cst);
+    }
+
+    ManualResetEvent::ManualResetEvent(JobSystemBase& js, bool initiallySet)
+        : m_js(js)
+        , m_set(initiallySet)
+    {
+    }
+
+    void ManualResetEvent::Set()
+    {
+        if (!m_set.exchange(true, std::memory_order_seq_cst))
+            m_js.WakeHelpers();
+    }
+
+    void ManualResetEvent::Reset()
+    {
+        m_set.store(false, std::memory_order_seq_cst);
+    }
+
+    bool ManualResetEvent::IsSet() const
+    {
+        return m_set.load(std::memory_order_seq_cst);
+    }
+
+    void ManualResetEvent::Wait()
+    {
+        m_js.HelpUntil([this] { return IsSet(); });
+    }
+
+    JobMutex::JobMutex(JobSystemBase& js)
+        : m_js(js)
+    {
+    }
+
+    bool JobMutex::TryAcquire(bool starving)
+    {
+        // In starvation mode only the starving waiter may take the lock, and it clears the mode.
+        uint32_t expected = starving ? kStarving : 0;
+        if (!m_state.compare_exchange_strong(expected, kLocked, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+        ++t_jobMutexesHeld;
+        return true;
+    }
+
+    bool JobMutex::TryLock()
+    {
+        return TryAcquire(false);
+    }
+
+    void JobMutex::Lock()
+    {
+        if (TryAcquire(false))
+            return;
+
+        for (uint32_t i = 0; i < kSpinCount; ++i)
+        {
+            if ((m_state.load(std::memory_order_relaxed) & kLocked) == 0 && TryAcquire(false))
+                return;
+            std::this_thread::yield();
+        }
+
+        const bool help = (t_jobMutexesHeld == 0 && !t_helpingForMutex);
+        const int64_t since = NowNs();
+        bool starving = false;
+
+        // Starvation mode; only one waiter holds it at a time. True if this one got it.
+        auto claimStarving = [this] {
+            uint32_t s = m_state.load(std::memory_order_relaxed);
+            while ((s & kStarving) == 0 && !m_state.compare_exchange_weak(s, s | kStarving, std::memory_order_relaxed))
+            {
+            }
+            return (s & kStarving) == 0;
+        };
+
+        for (;;)
+        {
+            if (TryAcquire(starving))
+                return;
+
+            if (!starving && NowNs() - since > kStarvationNs)
+            {
+                starving = claimStarving();
+                if (starving)
+                    continue;
+            }
+
+            if (help)
+            {
+                // A job run from here may lock this mutex too. With our claim standing it would
+                // park for good, since only we can clear it and we are below it on this stack:
+                // give the claim up while helping and take it back afterwards.
+                const bool wasStarving = starving;
+                if (starving)
+                {
+                    const uint32_t prev = m_state.fetch_and(~kStarving, std::memory_order_seq_cst);
+                    starving = false;
+                    if ((prev & kLocked) == 0 && m_waiters.load(std::memory_order_seq_cst) != 0)
+                        m_state.notify_all();
+                }
+
+                t_helpingForMutex = true;
+                const bool ran = m_js.HelpOne();
+                t_helpingForMutex = false;
+                if (ran)
+                    continue;
+
+                if (wasStarving)
+                    starving = claimStarving();
+            }
+
+            // Nothing to run: park until Unlock. Announce first, then re-check; Unlock pairs with
+            // it. Others may not take the lock while someone is starving.
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);
+            const uint32_t s = m_state.load(std::memory_order_seq_cst);
+            if ((s & (starving ? kLocked : kLocked | kStarving)) != 0)
+                m_state.wait(s, std::memory_order_seq_cst);
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void JobMutex::Unlock()
+    {
+        --t_jobMutexesHeld;
+
+        // Keep the starving bit: the starving waiter is next.
+        const uint32_t prev = m_state.fetch_and(~kLocked, std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        // The starving waiter may not be the one notify_one would pick.
+        if (prev & kStarving)
+            m_state.notify_all();
+        else
+            m_state.notify_one();
+    }
+} // namespace core
@@ -0,0 +1,543 @@
+#include "ThreadPool.h"
+
+#include "JobSystem.h"
+#include "Jobserver.h"
+#include "Profiler.h"
+#include "Topology.h"
+
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+    #include <climits>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <climits>
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace core
+{
+    // How long a worker waits for a jobserver token before re-checking for work and shutdown.
+    static constexpr uint32_t kTokenPollMs = 10;
+
+    namespace
+    {
+        // Pool and index of the worker running on this thread.
+        thread_local const ThreadPool* t_workerPool = nullptr;
+        thread_local uint32_t t_workerIndex = 0;
+
+        int64_t NowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Single-writer counters: a plain load and store, no locked read-modify-write.
+        void AddOwned(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    } // namespace
+
+    struct ThreadPool::WorkerThread
+    {
+        std::stop_source stop;
+#if defined(_WIN32)
+        HANDLE handle = nullptr;
+#else
+        pthread_t handle{};
+        bool joinable = false;
+#endif
+    };
+
+    namespace
+    {
+        struct WorkerStart
+        {
+            ThreadPool* pool;
+            uint32_t index;
+            std::stop_token st;
+        };
+    } // namespace
+
+    static void NameCurrentThread(const std::string& name)
+    {
+#if defined(_WIN32)
+        const std::wstring wide(name.begin(), name.end());
+        SetThreadDescription(GetCurrentThread(), wide.c_str());
+#elif defined(__APPLE__)
+        pthread_setname_np(name.c_str());
+#elif defined(__linux__)
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    // Moves the calling thread into the realtime scheduling class. Returns false if refused.
+    static bool ApplyRealtimePolicy(ThreadPool::RealtimePolicy policy, int priority, int nice)
+    {
+#if defined(_WIN32)
+        (void)priority;
+        (void)nice;
+        const int level = (policy == ThreadPool::RealtimePolicy::Nice) ? THREAD_PRIORITY_HIGHEST : THREAD_PRIORITY_TIME_CRITICAL;
+        return SetThreadPriority(GetCurrentThread(), level) != 0;
+#elif defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+        if (policy == ThreadPool::RealtimePolicy::Nice)
+        {
+    #if defined(__linux__)
+            // Linux applies nice values per thread (the tid), unlike POSIX.
+            return setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice) == 0;
+    #else
+            (void)nice;
+            return false;
+    #endif
+        }
+
+        const int cls = (policy == ThreadPool::RealtimePolicy::RoundRobin) ? SCHED_RR : SCHED_FIFO;
+        sched_param param{};
+        param.sched_priority = std::clamp(priority, sched_get_priority_min(cls), sched_get_priority_max(cls));
+        return pthread_setschedparam(pthread_self(), cls, &param) == 0;
+#else
+        (void)policy;
+        (void)priority;
+        (void)nice;
+        return false;
+#endif
+    }
+
+
+    ThreadPool::ThreadPool()
+        : ThreadPool(Config{})
+    {
+    }
+
+    ThreadPool::ThreadPool(const Config& cfg)
+        : m_cfg(cfg)
+    {
+        // Topology is only read when it matters: sysfs walks cost launch time on big machines.
+        if (m_cfg.topology)
+            m_topology = *m_cfg.topology;
+        else if (m_cfg.workerThreads == 0 || m_cfg.pinWorkers)
+            m_topology = DetectCpuTopology();
+
+        const uint32_t n = (m_cfg.workerThreads != 0) ? m_cfg.workerThreads : DefaultWorkerCount(m_topology);
+
+        m_highCapacity.assign(n, 1);
+        if (m_cfg.pinWorkers)
+        {
+            m_workerCpu = PlanWorkerPlacement(m_topology, n);
+
+            std::vector<bool> big(1, false);
+            for (const CpuInfo& c : m_topology.cpus)
+            {
+                if (c.cpu >= big.size())
+                    big.resize(c.cpu + 1, false);
+                big[c.cpu] = m_topology.IsHighCapacity(c);
+            }
+            for (uint32_t i = 0; i < n && i < m_workerCpu.size(); ++i)
+                m_highCapacity[i] = big[m_workerCpu[i]] ? 1 : 0;
+        }
+
+        if (m_cfg.useJobserver)
+            m_jobserver = JobserverClient::FromEnvironment();
+
+        m_workers = std::make_unique<WorkerThread[]>(n);
+        m_workerCount = n;
+        m_counters = std::make_unique<WorkerCounterCells[]>(n);
+        m_realtimeCount = std::min(m_cfg.realtimeWorkers, n - 1);
+        PlanStealOrder();
+
+        // Realtime workers exist to answer immediately, so they never start lazily. No destructor
+        // runs if a thread fails to start: stop and join the ones already running first.
+        try
+        {
+            std::lock_guard<std::mutex> lock(m_spawnMtx);
+            const uint32_t eager = m_cfg.lazyStart ? m_realtimeCount : n;
+            for (uint32_t i = 0; i < eager; ++i)
+                StartWorker(i);
+        }
+        catch (...)
+        {
+            Shutdown();
+            throw;
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        Shutdown();
+    }
+
+    void ThreadPool::PlanStealOrder()
+    {
+        // Distance between two workers' CPUs: 0 SMT siblings, 1 same L3, 2 same NUMA node,
+        // 3 remote. Without pinning nothing is known and every worker counts as shared-L3.
+        std::vector<const CpuInfo*> info(m_workerCount, nullptr);
+        for (uint32_t i = 0; i < m_workerCount && i < m_workerCpu.size(); ++i)
+        {
+            for (const CpuInfo& c : m_topology.cpus)
+            {
+                if (c.cpu == m_workerCpu[i])
+                    info[i] = &c;
+            }
+        }
+
+        auto distance = [&info](uint32_t a, uint32_t b) -> uint32_t {
+            if (!info[a] || !info[b])
+                return 1;
+            if (info[a]->core == info[b]->core)
+                return 0;
+            if (info[a]->l3 == info[b]->l3)
+                return 1;
+            return info[a]->numaNode == info[b]->numaNode ? 2 : 3;
+        };
+
+        m_stealOrder.assign(m_workerCount, {});
+        m_nearVictims.assign(m_workerCount, 0);
+        for (uint32_t w = 0; w < m_workerCount; ++w)
+        {
+            std::vector<uint32_t>& order = m_stealOrder[w];
+            for (uint32_t i = 1; i < m_workerCount; ++i)
+            {
+                const uint32_t victim = (w + i) % m_workerCount; // round-robin within a tier
+                if (!IsRealtimeWorker(victim))
+                    order.push_back(victim);
+            }
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return distance(w, a) < distance(w, b);
+            });
+            for (uint32_t victim : order)
+                m_nearVictims[w] += (distance(w, victim) <= 1) ? 1 : 0;
+        }
+    }
+
+    void ThreadPool::Shutdown()
+    {
+        uint32_t started = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_spawnMtx);
+            if (m_shutdown)
+                return;
+            m_shutdown = true;
+            started = m_started.load(std::memory_order_relaxed);
+        }
+
+        for (uint32_t i = 0; i < started; ++i)
+            m_workers[i].stop.request_stop();
+
+        NotifyAll();
+
+        for (uint32_t i = 0; i < started; ++i)
+        {
+            WorkerThread& w = m_workers[i];
+#if defined(_WIN32)
+            WaitForSingleObject(w.handle, INFINITE);
+            CloseHandle(w.handle);
+            w.handle = nullptr;
+#else
+            if (w.joinable)
+                pthread_join(w.handle, nullptr);
+            w.joinable = false;
+#endif
+        }
+        m_started.store(0, std::memory_order_release);
+    }
+
+    void ThreadPool::StartWorker(uint32_t index)
+    {
+        WorkerThread& w = m_workers[index];
+        auto start = std::make_unique<WorkerStart>(WorkerStart{this, index, w.stop.get_token()});
+        const size_t stackSize = m_cfg.hooks.stackSize;
+
+#if defined(_WIN32)
+        auto entry = [](LPVOID arg) -> DWORD {
+            std::unique_ptr<WorkerStart> s(static_cast<WorkerStart*>(arg));
+            s->pool->WorkerMain(s->st, s->index);
+            return 0;
+        };
+        w.handle = CreateThread(nullptr, stackSize, entry, start.get(), stackSize ? STACK_SIZE_PARAM_IS_A_RESERVATION : 0, nullptr);
+        if (!w.handle)
+            throw std::system_error((int)GetLastError(), std::system_category(), "CreateThread");
+#else
+        auto entry = [](void* arg) -> void* {
+            std::unique_ptr<WorkerStart> s(static_cast<WorkerStart*>(arg));
+            s->pool->WorkerMain(s->st, s->index);
+            return nullptr;
+        };
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (stackSize != 0)
+            pthread_attr_setstacksize(&attr, std::max<size_t>(stackSize, PTHREAD_STACK_MIN));
+        int err = pthread_create(&w.handle, &attr, entry, start.get());
+        pthread_attr_destroy(&attr);
+        if (err != 0 && stackSize != 0)
+            err = pthread_create(&w.handle, nullptr, entry, start.get()); // size refused: use the default
+        if (err != 0)
+            throw std::system_error(err, std::generic_category(), "pthread_create");
+        w.joinable = true;
+#endif
+        start.release(); // owned by the thread now
+        m_started.store(index + 1, std::memory_order_release);
+    }
+
+    void ThreadPool::StartWorkersFor(uint64_t backlog, uint32_t maxNew)
+    {
+        if (m_started.load(std::memory_order_acquire) >= m_workerCount)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_spawnMtx);
+        if (m_shutdown)
+            return;
+
+        uint32_t started = m_started.load(std::memory_order_relaxed);
+        const uint32_t ordinary = started - std::min(started, m_realtimeCount);
+        const uint32_t awake = ordinary - std::min(ordinary, m_sleepers.load(std::memory_order_seq_cst));
+
+        // Grow only while the backlog outnumbers the ordinary workers already awake.
+        for (uint32_t i = 0; i < maxNew && started < m_workerCount && backlog > awake + i; ++i)
+            StartWorker(started++);
+    }
+
+    void ThreadPool::NotifyOne(uint64_t backlog)
+    {
+        m_signal.fetch_add(1, std::memory_order_seq_cst);
+        const uint32_t sleepers = m_sleepers.load(std::memory_order_seq_cst);
+
+        // A sleeper about to be woken may not run for a while: grow once the backlog outnumbers
+        // every started ordinary worker, asleep or not.
+        if (m_cfg.lazyStart)
+        {
+            const uint32_t started = m_started.load(std::memory_order_acquire);
+            if (backlog > started - std::min(started, m_realtimeCount))
+                StartWorkersFor(backlog, 1);
+        }
+        if (sleepers == 0)
+            return;
+
+        // Pairs with the predicate check in WorkerLoop so the wakeup cannot be lost.
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMtx);
+        }
+        m_cvWork.notify_one();
+    }
+
+    void ThreadPool::NotifyAll(uint64_t backlog)
+    {
+        if (m_cfg.lazyStart)
+            StartWorkersFor(backlog, m_workerCount);
+
+        m_signal.fetch_add(1, std::memory_order_seq_cst);
+        m_rtSignal.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMtx);
+        }
+        m_cvWork.notify_all();
+        m_cvRealtime.notify_all();
+    }
+
+    void ThreadPool::NotifyRealtime()
+    {
+        m_rtSignal.fetch_add(1, std::memory_order_seq_cst);
+        if (m_rtSleepers.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMtx);
+        }
+        m_cvRealtime.notify_one();
+    }
+
+    ThreadPool::WorkerCounters ThreadPool::GetWorkerCounters(uint32_t workerIndex) const
+    {
+        WorkerCounters c{};
+        if (workerIndex >= m_workerCount)
+            return c;
+        const WorkerCounterCells& cells = m_counters[workerIndex];
+        c.spinNs = cells.spinNs.load(std::memory_order_relaxed);
+        c.parkedNs = cells.parkedNs.load(std::memory_order_relaxed);
+        c.wakeups = cells.wakeups.load(std::memory_order_relaxed);
+        c.spuriousWakeups = cells.spuriousWakeups.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    uint32_t ThreadPool::CurrentWorkerIndex() const
+    {
+        return (t_workerPool == this) ? t_workerIndex : kNotAWorker;
+    }
+
+    void ThreadPool::Attach(JobSystemBase* js)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_frontMtx);
+        m_frontends.push_back(js);
+    }
+
+    void ThreadPool::Detach(JobSystemBase* js)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_frontMtx);
+        m_frontends.erase(std::remove(m_frontends.begin(), m_frontends.end(), js), m_frontends.end());
+    }
+
+    bool ThreadPool::HasQueuedWork() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_frontMtx);
+        for (JobSystemBase* js : m_frontends)
+        {
+            if (js->HasQueuedWork())
+                return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::WorkerMain(std::stop_token st, uint32_t workerIndex)
+    {
+        t_workerPool = this;
+        t_workerIndex = workerIndex;
+
+        const WorkerHooks& hooks = m_cfg.hooks;
+        if (!hooks.namePrefix.empty())
+            NameCurrentThread(hooks.namePrefix + "-" + std::to_string(workerIndex));
+
+        if (workerIndex < m_workerCpu.size())
+            PinCurrentThreadToCpu(m_workerCpu[workerIndex]);
+
+        if (IsRealtimeWorker(workerIndex) && ApplyRealtimePolicy(m_cfg.realtimePolicy, m_cfg.realtimePriority, m_cfg.realtimeNice))
+            m_realtimeApplied.fetch_add(1, std::memory_order_acq_rel);
+
+        if (hooks.onStart)
+            hooks.onStart(workerIndex);
+
+        WorkerLoop(st, workerIndex);
+
+        if (hooks.onStop)
+            hooks.onStop(workerIndex);
+    }
+
+    void ThreadPool::WorkerLoop(std::stop_token st, uint32_t workerIndex)
+    {
+        size_t next = workerIndex; // stagger the round-robin start across workers
+        uint32_t nearMisses = 0;
+
+        WorkerCounterCells& counters = m_counters[workerIndex];
+        bool woken = false; // until the next dequeue attempt shows whether it was for nothing
+
+        const bool realtime = IsRealtimeWorker(workerIndex);
+
+        std::atomic<uint64_t>& signal = realtime ? m_rtSignal : m_signal;
+        std::atomic<uint32_t>& sleepers = realtime ? m_rtSleepers : m_sleepers;
+        std::condition_variable& cv = realtime ? m_cvRealtime : m_cvWork;
+
+        // The first ordinary worker runs on the process's implicit jobserver slot.
+        const bool needsToken = m_jobserver && !realtime && workerIndex != m_realtimeCount;
+        bool haveToken = false;
+        char token = 0;
+
+        while (!st.stop_requested())
+        {
+            const uint64_t seen = signal.load(std::memory_order_seq_cst);
+
+            // Extra workers only compete for a token while there is something to run.
+            if (needsToken && !haveToken && HasQueuedWork())
+            {
+                haveToken = m_jobserver->TryAcquire(kTokenPollMs, token);
+                if (!haveToken)
+                    continue;
+            }
+
+            // Steal only from near workers until localStealAttempts rounds came up empty.
+            const bool nearOnly = !realtime && nearMisses < m_cfg.localStealAttempts &&
+                                  m_nearVictims[workerIndex] < m_stealOrder[workerIndex].size();
+
+            JobSystemBase* owner = nullptr;
+            void* task = nullptr;
+            if (!needsToken || haveToken)
+            {
+                std::shared_lock<std::shared_mutex> lock(m_frontMtx);
+                const size_t count = m_frontends.size();
+                for (size_t i = 0; i < count && !owner; ++i)
+                {
+                    JobSystemBase* js = m_frontends[(next + i) % count];
+                    if (js->PoolDequeue(workerIndex, nearOnly, task))
+                        owner = js;
+                }
+                ++next;
+            }
+
+            // The dequeued job keeps its front-end in flight, so it cannot detach under us.
+            if (owner)
+            {
+                woken = false;
+                nearMisses = 0;
+                owner->PoolRun(workerIndex, task);
+                continue;
+            }
+
+            // Work queued further away: give nearer workers a moment before taking it.
+            if (nearOnly && HasQueuedWork())
+            {
+                ++nearMisses;
+                if (m_counterUsers.load(std::memory_order_relaxed) != 0)
+                {
+                    const int64_t spinStart = NowNs();
+                    std::this_thread::yield();
+                    AddOwned(counters.spinNs, (uint64_t)(NowNs() - spinStart));
+                }
+                else
+                    std::this_thread::yield();
+                continue;
+            }
+            nearMisses = 0;
+
+            if (woken)
+                AddOwned(counters.spuriousWakeups, 1);
+            woken = false;
+
+            if (haveToken)
+            {
+                m_jobserver->Release(token);
+                haveToken = false;
+            }
+
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> lock(m_sleepMtx);
+                auto ready = [&] {
+                    return st.stop_requested() || signal.load(std::memory_order_seq_cst) != seen;
+                };
+                if (!ready())
+                {
+                    JOBKIT_PROFILE_PARK(workerIndex);
+                    // Parking costs a syscall anyway; timing it always counts sleeps that began
+                    // before telemetry was switched on (e.g. workers that parked at start).
+                    const int64_t parkStart = NowNs();
+                    cv.wait(lock, ready);
+                    if (m_counterUsers.load(std::memory_order_relaxed) != 0)
+                    {
+                        AddOwned(counters.parkedNs, (uint64_t)(NowNs() - parkStart));
+                        AddOwned(counters.wakeups, 1);
+                        woken = true;
+                    }
+                    JOBKIT_PROFILE_UNPARK(workerIndex);
+                }
+            }
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (haveToken)
+            m_jobserver->Release(token);
+    }
+} // namespace core
@@ -0,0 +1,325 @@
+#include "Topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+    #include <sched.h>
+#elif defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+namespace core
+{
+    static bool ReadText(const std::string& path, std::string& out)
+    {
+        std::ifstream f(path);
+        if (!f)
+            return false;
+
+        std::stringstream ss;
+        ss << f.rdbuf();
+        out = ss.str();
+        while (!out.empty() && (out.back() == '\n' || out.back() == ' '))
+            out.pop_back();
+        return true;
+    }
+
+    // "0-3,8,10-11" -> {0,1,2,3,8,10,11}
+    static std::vector<uint32_t> ParseCpuList(const std::string& s)
+    {
+        std::vector<uint32_t> out;
+        std::stringstream ss(s);
+        std::string part;
+        while (std::getline(ss, part, ','))
+        {
+            if (part.empty())
+                continue;
+
+            const size_t dash = part.find('-');
+            const unsigned long lo = std::strtoul(part.c_str(), nullptr, 10);
+            const unsigned long hi = (dash == std::string::npos) ? lo : std::strtoul(part.c_str() + dash + 1, nullptr, 10);
+            for (unsigned long c = lo; c <= hi && c < 65536; ++c)
+                out.push_back((uint32_t)c);
+        }
+        return out;
+    }
+
+    static std::vector<uint32_t> ReadCpuList(const std::string& path)
+    {
+        std::string text;
+        return ReadText(path, text) ? ParseCpuList(text) : std::vector<uint32_t>();
+    }
+
+    static bool ReadUint(const std::string& path, uint64_t& out)
+    {
+        std::string text;
+        if (!ReadText(path, text) || text.empty())
+            return false;
+
+        char* end = nullptr;
+        out = std::strtoull(text.c_str(), &end, 10);
+        return end != text.c_str();
+    }
+
+    static std::string Parent(const std::string& dir)
+    {
+        const size_t slash = dir.find_last_of('/');
+        return (slash == std::string::npos || slash == 0) ? std::string() : dir.substr(0, slash);
+    }
+
+    // Quota in CPUs from cpu.max (v2) or cfs_quota_us/cfs_period_us (v1) along the process's
+    // cgroup path, taking the tightest ancestor. 0 = unlimited.
+    static double ReadCgroupQuota(const TopologySources& src)
+    {
+        const std::string base = src.sysRoot + "/fs/cgroup";
+
+        std::string v2Path;
+        std::string v1Path;
+        bool v1Found = false;
+        {
+            std::ifstream f(src.procSelfCgroup);
+            std::string line;
+            while (std::getline(f, line))
+            {
+                // hierarchy-id:controllers:path
+                const size_t a = line.find(':');
+                const size_t b = (a == std::string::npos) ? a : line.find(':', a + 1);
+                if (b == std::string::npos)
+                    continue;
+
+                const std::string controllers = line.substr(a + 1, b - a - 1);
+                const std::string path = line.substr(b + 1);
+                if (line.compare(0, a, "0") == 0 && controllers.empty())
+                    v2Path = path;
+
+                std::stringstream cs(controllers);
+                std::string c;
+                while (std::getline(cs, c, ','))
+                {
+                    if (c == "cpu")
+                    {
+                        v1Path = path;
+                        v1Found = true;
+                    }
+                }
+            }
+        }
+
+        double best = 0.0;
+        auto consider = [&best](double q) {
+            if (q > 0.0 && (best == 0.0 || q < best))
+                best = q;
+        };
+
+        // Inside a cgroup namespace the recorded path may not exist under our mount; walking up
+        // always ends at the mount root.
+        auto walk = [&](const std::string& root, const std::string& rel, auto&& readOne) {
+            std::string dir = root + ((rel == "/") ? std::string() : rel);
+            while (dir.size() >= root.size())
+            {
+                readOne(dir);
+                if (dir.size() == root.size())
+                    break;
+                dir = Parent(dir);
+            }
+        };
+
+        walk(base, v2Path.empty() ? std::string("/") : v2Path, [&](const std::string& dir) {
+            std::string text;
+            if (!ReadText(dir + "/cpu.max", text))
+                return;
+
+            std::stringstream ss(text);
+            std::string quota;
+            uint64_t period = 100000;
+            ss >> quota >> period;
+            if (quota != "max" && period > 0)
+                consider((double)std::strtoull(quota.c_str(), nullptr, 10) / (double)period);
+        });
+
+        if (v1Found)
+        {
+            for (const char* mount : {"/cpu", "/cpu,cpuacct", "/cpuacct,cpu"})
+            {
+                walk(base + mount, v1Path.empty() ? std::string("/") : v1Path, [&](const std::string& dir) {
+                    std::string quotaText;
+                    uint64_t period = 0;
+                    if (!ReadText(dir + "/cpu.cfs_quota_us", quotaText) || !ReadUint(dir + "/cpu.cfs_period_us", period))
+                        return;
+
+                    const long long quota = std::strtoll(quotaText.c_str(), nullptr, 10);
+                    if (quota > 0 && period > 0)
+                        consider((double)quota / (double)period);
+                });
+            }
+        }
+
+        return best;
+    }
+
+    static std::vector<uint32_t> AllowedCpus(const TopologySources& src, const std::vector<uint32_t>& online)
+    {
+#if defined(__linux__)
+        if (src.useAffinityMask)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+            {
+                std::vector<uint32_t> out;
+                for (uint32_t c : online)
+                {
+                    if (c < CPU_SETSIZE && CPU_ISSET(c, &set))
+                        out.push_back(c);
+                }
+                return out;
+            }
+        }
+#else
+        (void)src;
+#endif
+        return online;
+    }
+
+    CpuTopology DetectCpuTopology(const TopologySources& src)
+    {
+        CpuTopology topo{};
+        const std::string cpuDir = src.sysRoot + "/devices/system/cpu";
+
+        std::vector<uint32_t> online = ReadCpuList(cpuDir + "/online");
+        if (online.empty())
+        {
+            const uint32_t hc = std::max(1u, std::thread::hardware_concurrency());
+            for (uint32_t c = 0; c < hc; ++c)
+                online.push_back(c);
+        }
+
+        std::vector<uint32_t> allowed = AllowedCpus(src, online);
+        if (allowed.empty())
+            allowed = online;
+
+        std::map<uint32_t, uint32_t> nodeOf;
+        const std::string nodeDir = src.sysRoot + "/devices/system/node";
+        for (uint32_t node : ReadCpuList(nodeDir + "/possible"))
+        {
+            for (uint32_t c : ReadCpuList(nodeDir + "/node" + std::to_string(node) + "/cpulist"))
+                nodeOf[c] = node;
+        }
+
+        // Intel hybrid parts list their efficiency cores here instead of exposing cpu_capacity.
+        const std::vector<uint32_t> atoms = ReadCpuList(src.sysRoot + "/devices/cpu_atom/cpus");
+        const std::set<uint32_t> atomSet(atoms.begin(), atoms.end());
+
+        std::set<uint32_t> coresSeen;
+        topo.maxCapacity = 0;
+        for (uint32_t c : allowed)
+        {
+            CpuInfo info{};
+            info.cpu = c;
+
+            const std::string dir = cpuDir + "/cpu" + std::to_string(c);
+
+            std::vector<uint32_t> siblings = ReadCpuList(dir + "/topology/thread_siblings_list");
+            if (siblings.empty())
+                siblings = ReadCpuList(dir + "/topology/core_cpus_list");
+            info.core = siblings.empty() ? c : *std::min_element(siblings.begin(), siblings.end());
+
+            uint64_t capacity = 0;
+            if (ReadUint(dir + "/cpu_capacity", capacity) && capacity > 0)
+                info.capacity = (uint32_t)capacity;
+            else if (atomSet.count(c))
+                info.capacity = 512;
+
+            // Highest cache level shared by this CPU: its key is the lowest CPU sharing it.
+            uint64_t bestLevel = 0;
+            info.l3 = 0;
+            for (uint32_t idx = 0; idx < 16; ++idx)
+            {
+                const std::string cache = dir + "/cache/index" + std::to_string(idx);
+                uint64_t level = 0;
+                if (!ReadUint(cache + "/level", level))
+                    break;
+                if (level < bestLevel)
+                    continue;
+
+                const std::vector<uint32_t> shared = ReadCpuList(cache + "/shared_cpu_list");
+                if (shared.empty())
+                    continue;
+
+                bestLevel = level;
+                info.l3 = *std::min_element(shared.begin(), shared.end());
+            }
+
+            auto node = nodeOf.find(c);
+            info.numaNode = (node == nodeOf.end()) ? 0 : node->second;
+
+            info.smtPrimary = coresSeen.insert(info.core).second;
+            topo.maxCapacity = std::max(topo.maxCapacity, info.capacity);
+            topo.cpus.push_back(info);
+        }
+
+        topo.physicalCores = (uint32_t)coresSeen.size();
+        if (topo.maxCapacity == 0)
+            topo.maxCapacity = 1024;
+
+        topo.cpuQuota = ReadCgroupQuota(src);
+        return topo;
+    }
+
+    uint32_t DefaultWorkerCount(const CpuTopology& topo)
+    {
+        uint32_t n = topo.physicalCores ? topo.physicalCores : (uint32_t)topo.cpus.size();
+        if (topo.cpuQuota > 0.0)
+            n = std::min(n, (uint32_t)std::ceil(topo.cpuQuota));
+        return std::max(n, 1u);
+    }
+
+    std::vector<uint32_t> PlanWorkerPlacement(const CpuTopology& topo, uint32_t workers)
+    {
+        std::vector<CpuInfo> order = topo.cpus;
+        std::stable_sort(order.begin(), order.end(), [](const CpuInfo& a, const CpuInfo& b) {
+            if (a.smtPrimary != b.smtPrimary)
+                return a.smtPrimary;
+            return a.capacity > b.capacity;
+        });
+
+        std::vector<uint32_t> out;
+        if (order.empty())
+            return out;
+
+        out.reserve(workers);
+        for (uint32_t i = 0; i < workers; ++i)
+            out.push_back(order[i % order.size()].cpu);
+        return out;
+    }
+
+    bool PinCurrentThreadToCpu(uint32_t cpu)
+    {
+#if defined(__linux__)
+        if (cpu >= CPU_SETSIZE)
+            return false;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+        if (cpu >= 64)
+            return false;
+        return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+} // namespace core
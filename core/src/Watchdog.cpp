@@ -0,0 +1,130 @@
+#include "Watchdog.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace core
+{
+    namespace
+    {
+        int64_t NowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    } // namespace
+
+    StallWatchdog::StallWatchdog(const JobSystemBase& js, Config cfg)
+        : m_js(js)
+        , m_cfg(std::move(cfg))
+    {
+        m_thread = std::jthread([this](std::stop_token st) { Run(st); });
+    }
+
+    StallWatchdog::~StallWatchdog()
+    {
+        m_thread.request_stop(); // wakes the interval wait
+        m_thread.join();
+    }
+
+    int64_t StallWatchdog::BudgetFor(LabelId label)
+    {
+        if (label == LabelRegistry::kNone)
+            return m_cfg.defaultBudgetNs;
+
+        // Resolve each label id by text once.
+        if (m_budgetCache.size() <= label)
+            m_budgetCache.resize(label + 1, -1);
+        if (m_budgetCache[label] >= 0)
+            return m_budgetCache[label];
+
+        int64_t budget = m_cfg.defaultBudgetNs;
+        const char* name = LabelRegistry::Name(label);
+        for (const auto& [text, ns] : m_cfg.budgetsNs)
+        {
+            if (name && text == name)
+            {
+                budget = ns;
+                break;
+            }
+        }
+        m_budgetCache[label] = budget;
+        return budget;
+    }
+
+    void StallWatchdog::SampleNow()
+    {
+        std::lock_guard<std::mutex> lock(m_sampleMtx);
+
+        const std::vector<JobSystemBase::Diagnostics::Worker> workers = m_js.GetWorkerDiagnostics();
+        const int64_t now = NowNs();
+        m_seen.resize(workers.size());
+
+        for (const JobSystemBase::Diagnostics::Worker& w : workers)
+        {
+            Seen& seen = m_seen[w.workerIndex];
+            if (!w.running || w.runningTaskId == 0)
+            {
+                seen = Seen{};
+                continue;
+            }
+
+            // The fields are read one by one while the worker moves on; a job is only taken
+            // as stalled once the previous sample saw it with the same start. Jobs whose start
+            // was not sampled count from the first sample that saw them.
+            const int64_t sinceNs = (w.runningSinceNs != 0) ? w.runningSinceNs : now;
+            const bool same = (seen.taskId == w.runningTaskId &&
+                               (w.runningSinceNs == 0 || seen.sinceNs == w.runningSinceNs));
+            if (!same)
+            {
+                seen = Seen{w.runningTaskId, sinceNs, false};
+                continue;
+            }
+
+            const int64_t budget = BudgetFor(w.runningLabelId);
+            const int64_t running = now - seen.sinceNs;
+            if (seen.reported || budget == 0 || running <= budget)
+                continue;
+
+            seen.reported = true;
+            m_stalls.fetch_add(1, std::memory_order_relaxed);
+
+            const Stall stall{w.workerIndex, w.runningTaskId, w.runningLabel, running, budget};
+            if (m_cfg.onStall)
+                m_cfg.onStall(stall);
+            else
+                std::fprintf(stderr, "jobkit: job %" PRIu64 " (%s) on worker %u running for %.1f ms, budget %.1f ms\n",
+                             stall.taskId, stall.label ? stall.label : "unlabeled", stall.workerIndex,
+                             (double)stall.runningNs / 1e6, (double)stall.budgetNs / 1e6);
+        }
+
+        if (m_cfg.starvationNs == 0)
+            return;
+
+        const JobSystemBase::QueueAges ages = m_js.GetQueueAges(m_cfg.starvationNs);
+        m_starved.store(ages.olderThan, std::memory_order_relaxed);
+        if (ages.olderThan == 0)
+            return;
+
+        if (m_cfg.onStarvation)
+            m_cfg.onStarvation(ages);
+        else
+            std::fprintf(stderr, "jobkit: %" PRIu64 " of %" PRIu64 " ready jobs queued longer than %.1f ms (oldest %.1f ms)\n",
+                         ages.olderThan, ages.ready, (double)m_cfg.starvationNs / 1e6, (double)ages.oldestNs / 1e6);
+    }
+
+    void StallWatchdog::Run(std::stop_token st)
+    {
+        std::unique_lock<std::mutex> lock(m_sleepMtx);
+        while (!st.stop_requested())
+        {
+            m_cv.wait_for(lock, st, m_cfg.interval, [] { return false; }); // stop wakes it early
+            if (st.stop_requested())
+                break;
+
+            lock.unlock();
+            SampleNow();
+            lock.lock();
+        }
+    }
+} // namespace core
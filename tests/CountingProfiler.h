@@ -0,0 +1,30 @@
+#pragma once
+
+// Profiler backend for test_profiler.cpp: counts every hook.
+
+#include <atomic>
+#include <cstdint>
+
+namespace jobkit_test
+{
+    struct ProfileCounts
+    {
+        std::atomic<uint64_t> submits{0};
+        std::atomic<uint64_t> labelledSubmits{0};
+        std::atomic<uint64_t> begins{0};
+        std::atomic<uint64_t> ends{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> parks{0};
+        std::atomic<uint64_t> unparks{0};
+    };
+
+    inline ProfileCounts g_profile;
+} // namespace jobkit_test
+
+#define JOBKIT_PROFILE_SUBMIT(label) \
+    (jobkit_test::g_profile.submits.fetch_add(1), jobkit_test::g_profile.labelledSubmits.fetch_add((label) ? 1 : 0))
+#define JOBKIT_PROFILE_JOB_BEGIN(label, worker) ((void)(label), (void)(worker), jobkit_test::g_profile.begins.fetch_add(1))
+#define JOBKIT_PROFILE_JOB_END(label, worker) ((void)(label), (void)(worker), jobkit_test::g_profile.ends.fetch_add(1))
+#define JOBKIT_PROFILE_STEAL(thief, victim) ((void)(thief), (void)(victim), jobkit_test::g_profile.steals.fetch_add(1))
+#define JOBKIT_PROFILE_PARK(worker) ((void)(worker), jobkit_test::g_profile.parks.fetch_add(1))
+#define JOBKIT_PROFILE_UNPARK(worker) ((void)(worker), jobkit_test::g_profile.unparks.fetch_add(1))
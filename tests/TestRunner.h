@@ -0,0 +1,29 @@
+#pragma once
+
+#include <iostream>
+
+namespace
+{
+    struct TestRunner
+    {
+        int failures = 0;
+
+        void Check(bool condition, const char* expr, const char* file, int line)
+        {
+            if (condition)
+                return;
+
+            ++failures;
+            std::cerr << "FAIL " << file << ":" << line << " " << expr << "\n";
+        }
+
+        int Finish() const
+        {
+            if (failures == 0)
+                std::cout << "All tests passed\n";
+            return failures == 0 ? 0 : 1;
+        }
+    };
+} // namespace
+
+#define CHECK(expr) runner.Check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
@@ -1,38 +1,34 @@
 #include "JobSystem.h"
+#include "JobSystemImpl.h"
+#include "Metrics.h"
+#include "Sync.h"
+#include "TestRunner.h"
+#include "Watchdog.h"
+#include "WorkerLocal.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <functional>
-#include <iostream>
+#include <memory>
 #include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
 
-namespace
-{
-    struct TestRunner
-    {
-        int failures = 0;
-
-        void Check(bool condition, const char* expr, const char* file, int line)
-        {
-            if (condition)
-                return;
-
-            ++failures;
-            std::cerr << "FAIL " << file << ":" << line << " " << expr << "\n";
-        }
-
-        int Finish() const
-        {
-            if (failures == 0)
-                std::cout << "All tests passed\n";
-            return failures == 0 ? 0 : 1;
-        }
-    };
-} // namespace
-
-#define CHECK(expr) runner.Check((expr), #expr, __FILE__, __LINE__)
+#if !defined(_WIN32)
+    #include <cstdlib>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
 
 static void TestBasicSubmit(TestRunner& runner)
 {
@@ -123,6 +119,1643 @@ static void TestRejectEmpty(TestRunner& runner)
     CHECK(!js.Submit(empty));
 }
 
+static void TestTaskStorage(TestRunner& runner)
+{
+    auto token = std::make_shared<int>(0);
+    std::atomic<int> ran{0};
+
+    {
+        core::JobSystem::Config cfg{};
+        cfg.workerThreads = 1;
+        core::JobSystem js(cfg);
+
+        // Move-only capture, stored inline.
+        auto owned = std::make_unique<int>(7);
+        CHECK(js.Submit([&ran, owned = std::move(owned)] { ran.fetch_add(*owned, std::memory_order_relaxed); }));
+
+        // Too big for the inline payload: goes to the heap, still runs and is freed.
+        struct Big
+        {
+            char bytes[core::JobSystem::kInlineTaskBytes * 2] = {};
+        };
+        CHECK(js.Submit([&ran, big = Big{}, token] { ran.fetch_add(1 + big.bytes[0], std::memory_order_relaxed); }));
+
+        // A throwing job still releases its captures.
+        CHECK(js.Submit([token] { throw 1; }));
+
+        js.WaitIdle();
+        CHECK(ran.load(std::memory_order_relaxed) == 8);
+        CHECK(token.use_count() == 1);
+
+        // Cancelled jobs destroy their captures without running.
+        std::atomic<bool> release{false};
+        CHECK(js.Submit([&release] {
+            while (!release.load(std::memory_order_acquire))
+                std::this_thread::yield();
+        }));
+        for (int i = 0; i < 10; ++i)
+            CHECK(js.Submit([&ran, token] { ran.fetch_add(100, std::memory_order_relaxed); }));
+
+        std::thread stopper([&js] { js.Stop(core::JobSystem::StopMode::CancelPending); });
+        while (js.GetStats().queued != 0)
+            std::this_thread::yield();
+        release.store(true, std::memory_order_release);
+        stopper.join();
+    }
+
+    CHECK(ran.load(std::memory_order_relaxed) == 8);
+    CHECK(token.use_count() == 1);
+}
+
+static void TestJobHandles(TestRunner& runner)
+{
+    using Handle = core::JobSystem::JobHandle;
+
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    core::JobSystem js(cfg);
+
+    CHECK(js.IsDone(Handle{}));
+
+    // Diamond: a -> (b, c) -> d.
+    std::mutex orderMtx;
+    std::vector<char> order;
+    auto step = [&](char name) {
+        return [&, name] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::lock_guard<std::mutex> lock(orderMtx);
+            order.push_back(name);
+        };
+    };
+
+    const Handle a = js.Submit(step('a'));
+    core::JobSystem::SubmitOptions afterA{};
+    afterA.dependsOn = std::span(&a, 1);
+    const Handle b = js.Submit(afterA, step('b'));
+    const Handle c = js.Submit(afterA, step('c'));
+
+    const Handle bc[] = {b, c};
+    core::JobSystem::SubmitOptions afterBC{};
+    afterBC.dependsOn = bc;
+    const Handle d = js.Submit(afterBC, step('d'));
+    CHECK(a && b && c && d);
+
+    js.Wait(d);
+    CHECK(js.IsDone(a) && js.IsDone(b) && js.IsDone(c) && js.IsDone(d));
+    {
+        std::lock_guard<std::mutex> lock(orderMtx);
+        CHECK(order.size() == 4);
+        if (order.size() == 4)
+        {
+            CHECK(order.front() == 'a');
+            CHECK(order.back() == 'd');
+        }
+    }
+
+    // Slots are reused; an old handle still reports done, the new job is tracked separately.
+    std::atomic<bool> release{false};
+    std::atomic<bool> blocking{false};
+    const Handle blocker = js.Submit([&release, &blocking] {
+        blocking.store(true, std::memory_order_release);
+        while (!release.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    });
+    CHECK(!js.IsDone(blocker));
+
+    // Keep it on a worker: a helping Wait below could otherwise pick it up and spin forever.
+    while (!blocking.load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    // Jobs held back by the blocker keep their slots, so within a slab chunk one of them lands
+    // in a slot the diamond freed, whichever the free list hands out first.
+    const Handle diamond[] = {a, b, c, d};
+    core::JobSystem::SubmitOptions afterBlocker{};
+    afterBlocker.dependsOn = std::span(&blocker, 1);
+    Handle stale{};
+    Handle reused{};
+    for (int i = 0; i < 256 && !stale; ++i)
+    {
+        const Handle h = js.Submit(afterBlocker, [] {});
+        for (const Handle& old : diamond)
+        {
+            if (h.index == old.index)
+            {
+                stale = old;
+                reused = h;
+            }
+        }
+    }
+    CHECK(stale && reused.generation != stale.generation);
+    CHECK(js.IsDone(stale) && !js.IsDone(reused));
+    CHECK(js.IsDone(a) && js.IsDone(d));
+
+    // Dependencies on finished jobs are already satisfied.
+    core::JobSystem::SubmitOptions afterD{};
+    afterD.dependsOn = std::span(&d, 1);
+    std::atomic<bool> ranAfterD{false};
+    js.Wait(js.Submit(afterD, [&ranAfterD] { ranAfterD.store(true, std::memory_order_release); }));
+    CHECK(ranAfterD.load(std::memory_order_acquire));
+
+    release.store(true, std::memory_order_release);
+    js.Wait(blocker);
+    js.WaitIdle();
+    CHECK(js.GetStats().waiting == 0);
+
+    // Waiting inside a job helps run the queue, so one worker cannot deadlock on its children.
+    core::JobSystem::Config oneCfg{};
+    oneCfg.workerThreads = 1;
+    core::JobSystem one(oneCfg);
+    std::atomic<int> sum{0};
+    one.Wait(one.Submit([&] {
+        Handle children[4];
+        for (int i = 0; i < 4; ++i)
+            children[i] = one.Submit([&sum, i] { sum.fetch_add(i + 1, std::memory_order_relaxed); });
+        for (const Handle& h : children)
+            one.Wait(h);
+        CHECK(sum.load(std::memory_order_relaxed) == 10);
+    }));
+    CHECK(sum.load(std::memory_order_relaxed) == 10);
+
+    // Cancelling drops waiting jobs too, and their handles report done.
+    core::JobSystem cancel(oneCfg);
+    std::atomic<bool> go{false};
+    const Handle head = cancel.Submit([&go] {
+        while (!go.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    });
+    core::JobSystem::SubmitOptions afterHead{};
+    afterHead.dependsOn = std::span(&head, 1);
+    std::atomic<int> ranDependent{0};
+    const Handle tail = cancel.Submit(afterHead, [&ranDependent] { ranDependent.fetch_add(1); });
+    CHECK(cancel.GetStats().waiting == 1);
+
+    std::thread stopper([&cancel] { cancel.Stop(core::JobSystem::StopMode::CancelPending); });
+    while (!cancel.IsDone(tail))
+        std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+    stopper.join();
+    CHECK(cancel.IsDone(head));
+    CHECK(ranDependent.load() == 0);
+}
+
+static void TestParallelForAligned(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 3;
+    core::JobSystem js(cfg);
+
+    constexpr size_t kCount = 1000;
+    alignas(64) static float out[kCount];
+    std::atomic<int> touched[kCount];
+    for (std::atomic<int>& t : touched)
+        t.store(0, std::memory_order_relaxed);
+
+    core::JobSystem::ParallelForOptions opts{};
+    opts.alignment = core::JobSystem::CacheLineElements<float>();
+    opts.grainSize = 50;
+
+    std::atomic<int> misaligned{0};
+    std::atomic<int> chunks{0};
+    js.ParallelFor(kCount, opts, [&](size_t begin, size_t end) {
+        if (begin % 16 != 0 || (end != kCount && end % 16 != 0))
+            misaligned.fetch_add(1, std::memory_order_relaxed);
+        chunks.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = begin; i < end; ++i)
+        {
+            out[i] = (float)i * 2.0f;
+            touched[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    CHECK(opts.alignment == 16);
+    CHECK(misaligned.load() == 0);
+    CHECK(chunks.load() == 16); // grain 50 rounds up to 64; the last chunk holds 40
+    bool once = true;
+    for (size_t i = 0; i < kCount; ++i)
+        once = once && touched[i].load(std::memory_order_relaxed) == 1 && out[i] == (float)i * 2.0f;
+    CHECK(once);
+
+    // Default grain, empty range, and from inside a job.
+    std::atomic<size_t> sum{0};
+    js.ParallelFor(kCount, [&sum](size_t begin, size_t end) { sum.fetch_add(end - begin); });
+    CHECK(sum.load() == kCount);
+    js.ParallelFor(0, [&sum](size_t, size_t) { sum.store(0); });
+    CHECK(sum.load() == kCount);
+
+    js.Wait(js.Submit([&] {
+        js.ParallelFor(kCount, opts, [&sum](size_t begin, size_t end) { sum.fetch_add(end - begin); });
+    }));
+    CHECK(sum.load() == 2 * kCount);
+
+    // A throw from a chunk the caller did not run still reaches the caller.
+    for (int run = 0; run < 20; ++run)
+    {
+        bool caught = false;
+        try
+        {
+            js.ParallelFor(kCount, opts, [](size_t begin, size_t) {
+                if (begin == 512)
+                    throw std::runtime_error("chunk");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        CHECK(caught);
+    }
+}
+
+static thread_local uint32_t t_nestedDepth = 0;
+
+// Jobs nested on this thread's stack, and the most seen on any thread.
+struct NestedJobScope
+{
+    explicit NestedJobScope(std::atomic<uint32_t>& maxDepth)
+    {
+        const uint32_t depth = ++t_nestedDepth;
+        uint32_t seen = maxDepth.load(std::memory_order_relaxed);
+        while (depth > seen && !maxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed))
+        {
+        }
+    }
+    ~NestedJobScope() { --t_nestedDepth; }
+};
+
+static uint64_t ParallelFib(core::JobSystem& js, uint32_t n, std::atomic<uint32_t>& maxDepth)
+{
+    if (n < 2)
+        return n;
+
+    uint64_t a = 0;
+    core::JobSystem::JobHandle h = js.Submit([&js, &a, &maxDepth, n] {
+        const NestedJobScope scope(maxDepth);
+        a = ParallelFib(js, n - 1, maxDepth);
+    });
+    const uint64_t b = ParallelFib(js, n - 2, maxDepth);
+    js.Wait(h);
+    return a + b;
+}
+
+static void ParallelQuicksort(core::JobSystem& js, int* first, int* last)
+{
+    while (last - first > 2048)
+    {
+        const int pivot = first[(last - first) / 2];
+        int* mid1 = std::partition(first, last, [pivot](int v) { return v < pivot; });
+        int* mid2 = std::partition(mid1, last, [pivot](int v) { return v == pivot; });
+
+        core::JobSystem::JobHandle left = js.Submit([&js, first, mid1] { ParallelQuicksort(js, first, mid1); });
+        ParallelQuicksort(js, mid2, last);
+        js.Wait(left);
+        return;
+    }
+    std::sort(first, last);
+}
+
+static void TestNestedParallelism(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 3;
+    cfg.maxHelpDepth = 64;
+    core::JobSystem js(cfg);
+
+    // Fork-join recursion 30 levels deep, a job per call, waited on from worker and caller
+    // threads.
+    std::atomic<uint32_t> maxDepth{0};
+    uint64_t fib = 0;
+    js.Wait(js.Submit([&] { fib = ParallelFib(js, 30, maxDepth); }));
+    CHECK(fib == 832040);
+    CHECK(maxDepth.load() <= cfg.maxHelpDepth);
+
+    // A chain of 30 jobs each waiting on the next, with maxHelpDepth below that: a thread at
+    // the limit blocks instead of running the next link, which another thread picks up.
+    core::JobSystem::Config shallowCfg = cfg;
+    shallowCfg.maxHelpDepth = 12;
+    core::JobSystem shallow(shallowCfg);
+    std::atomic<uint32_t> chainDepth{0};
+    std::function<void(uint32_t)> chain = [&](uint32_t left) {
+        if (left == 0)
+            return;
+        shallow.Wait(shallow.Submit([&chain, &chainDepth, left] {
+            const NestedJobScope scope(chainDepth);
+            chain(left - 1);
+        }));
+    };
+    chain(30);
+    CHECK(shallow.GetStats().completed == 30);
+    CHECK(chainDepth.load() <= shallowCfg.maxHelpDepth);
+
+    std::vector<int> values(200000);
+    uint32_t x = 12345;
+    for (int& v : values)
+    {
+        x = x * 1664525u + 1013904223u;
+        v = (int)(x >> 8) % 5000; // plenty of duplicates
+    }
+    js.Wait(js.Submit([&] { ParallelQuicksort(js, values.data(), values.data() + values.size()); }));
+    CHECK(std::is_sorted(values.begin(), values.end()));
+
+    // ParallelFor inside ParallelFor, and WaitIdle from inside jobs.
+    std::atomic<size_t> cells{0};
+    js.ParallelFor(64, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row)
+            js.ParallelFor(64, [&cells](size_t b, size_t e) { cells.fetch_add(e - b); });
+    });
+    CHECK(cells.load() == 64 * 64);
+
+    std::atomic<int> leaves{0};
+    for (int i = 0; i < 4; ++i)
+    {
+        js.Submit([&] {
+            for (int j = 0; j < 8; ++j)
+                js.Submit([&leaves] { leaves.fetch_add(1); });
+            js.WaitIdle();
+        });
+    }
+    js.WaitIdle();
+    CHECK(leaves.load() == 32);
+    CHECK(js.GetStats().inFlight == 0);
+}
+
+static void TestWorkerLocal(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 3;
+    core::JobSystem js(cfg);
+
+    // Histogram of 0..9999 by last digit, with no shared writes while jobs run.
+    using Histogram = std::array<uint32_t, 10>;
+    core::WorkerLocal<Histogram> hist(js, Histogram{});
+    js.ParallelFor(10000, [&hist](size_t begin, size_t end) {
+        Histogram& h = hist.Local();
+        for (size_t i = begin; i < end; ++i)
+            ++h[i % 10];
+    });
+    js.WaitIdle();
+
+    const Histogram total = hist.Combine([](Histogram acc, const Histogram& h) {
+        for (size_t i = 0; i < acc.size(); ++i)
+            acc[i] += h[i];
+        return acc;
+    });
+    bool even = true;
+    for (uint32_t bucket : total)
+        even = even && bucket == 1000;
+    CHECK(even);
+
+    // Instances sit on separate cache lines; the calling thread gets one of its own.
+    core::WorkerLocal<uint64_t> counts(js);
+    std::vector<const uint64_t*> seen;
+    for (int i = 0; i < 64; ++i)
+        js.Submit([&counts] { ++counts.Local(); });
+    ++counts.Local();
+    js.WaitIdle();
+    counts.ForEach([&seen](uint64_t& c) { seen.push_back(&c); });
+    CHECK(seen.size() == 4);
+    bool padded = true;
+    for (const uint64_t* p : seen)
+        padded = padded && reinterpret_cast<uintptr_t>(p) % 64 == 0;
+    CHECK(padded);
+    CHECK(counts.Combine([](uint64_t a, uint64_t b) { return a + b; }) == 65);
+
+    counts.Clear();
+    CHECK(counts.Combine([](uint64_t a, uint64_t b) { return a + b; }) == 0);
+    ++counts.Local(); // the caller's cached instance was dropped by Clear
+    CHECK(counts.Combine([](uint64_t a, uint64_t b) { return a + b; }) == 1);
+
+    // init is each instance's starting value, counted once per instance.
+    core::WorkerLocal<int> fives(js, 5);
+    CHECK(fives.Combine([](int a, int b) { return a + b; }) == 15);
+}
+
+// Configurations other than core::JobSystem, instantiated here from JobSystemImpl.h.
+using SharedSpinSystem = core::JobSystemT<core::SharedQueues, core::SpinThenPark<64>, core::NoTelemetry, core::InlineTaskStorage<16>>;
+using TracedSystem = core::JobSystemT<core::WorkStealingQueues, core::ParkWhenIdle, core::FullTelemetry, core::InlineTaskStorage<112>>;
+
+static void TestPolicies(TestRunner& runner)
+{
+    static_assert(SharedSpinSystem::kInlineTaskBytes == 16);
+
+    core::ThreadPool::Config poolCfg{};
+    poolCfg.workerThreads = 3;
+    auto pool = std::make_shared<core::ThreadPool>(poolCfg);
+
+    core::JobSystem::Config cfg{};
+    cfg.pool = pool;
+    cfg.telemetry.enabled = true;
+    SharedSpinSystem shared(cfg);
+    TracedSystem traced(cfg);
+    core::JobSystem plain(cfg);
+
+    // Workers submit into the shared lanes only; nested waits and fork-join still help.
+    std::atomic<int> sum{0};
+    for (int i = 0; i < 8; ++i)
+    {
+        CHECK(shared.Submit([&shared, &sum] {
+            shared.ParallelFor(64, [&sum](size_t begin, size_t end) {
+                sum.fetch_add(static_cast<int>(end - begin), std::memory_order_relaxed);
+            });
+        }));
+    }
+
+    // Captures above the inline size go to the heap.
+    std::array<int64_t, 4> big{1, 2, 3, 4};
+    std::atomic<int64_t> bigSum{0};
+    CHECK(shared.Submit([big, &bigSum] {
+        for (int64_t v : big)
+            bigSum.fetch_add(v, std::memory_order_relaxed);
+    }));
+
+    core::Latch latch(shared, 4);
+    for (int i = 0; i < 4; ++i)
+        CHECK(shared.Submit([&latch] { latch.CountDown(); }));
+    latch.Wait();
+
+    shared.WaitIdle();
+    CHECK(sum.load(std::memory_order_relaxed) == 8 * 64);
+    CHECK(bigSum.load(std::memory_order_relaxed) == 10);
+    CHECK(shared.GetStats().completed >= 13);
+
+    // A FullTelemetry type can be switched on whatever the library was built with.
+    for (int i = 0; i < 10; ++i)
+        CHECK(traced.SubmitLabeled("traced", [] {}));
+    std::atomic<bool> plainRan{false};
+    CHECK(plain.Submit([&plainRan] { plainRan.store(true, std::memory_order_relaxed); }));
+    traced.WaitIdle();
+    plain.WaitIdle();
+    CHECK(plainRan.load(std::memory_order_relaxed));
+
+    const std::vector<core::JobSystemBase::LabelHistogram> histograms = traced.GetLabelHistograms();
+    uint64_t tracedCount = 0;
+    for (const core::JobSystemBase::LabelHistogram& h : histograms)
+    {
+        if (h.label == "traced")
+            tracedCount = h.count;
+    }
+    CHECK(tracedCount == 10);
+}
+
+static void TestTelemetrySampling(TestRunner& runner)
+{
+    TracedSystem::Config cfg{};
+    cfg.workerThreads = 1; // one sample tick; the main thread never runs a job
+    cfg.telemetry = {true, 8};
+    TracedSystem js(cfg);
+
+    auto runLabeled = [&js](int n) {
+        for (int i = 0; i < n; ++i)
+            js.SubmitLabeled("sampled", [] {});
+        js.WaitIdle();
+    };
+    auto counts = [&js](uint64_t& jobs, uint64_t& timed) {
+        jobs = js.GetWorkerDiagnostics()[0].jobsExecuted;
+        timed = 0;
+        for (const core::JobSystemBase::LabelHistogram& h : js.GetLabelHistograms())
+            timed += h.count;
+    };
+
+    uint64_t jobs = 0, timed = 0;
+    runLabeled(64);
+    counts(jobs, timed);
+    CHECK(jobs == 64);
+    CHECK(timed == 8);
+
+    // Off at run time: no bookkeeping at all.
+    js.SetTelemetry({false, 8});
+    runLabeled(16);
+    counts(jobs, timed);
+    CHECK(jobs == 64);
+    CHECK(timed == 8);
+    CHECK(!js.GetTelemetry().enabled);
+
+    // A detailed capture times every job, even while switched off ...
+    js.CaptureDetailed(std::chrono::seconds(10));
+    runLabeled(16);
+    counts(jobs, timed);
+    CHECK(jobs == 80);
+    CHECK(timed == 24);
+
+    // ... and the first job after it ends restores the settings.
+    js.CaptureDetailed(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    runLabeled(1);
+    runLabeled(16);
+    counts(jobs, timed);
+    CHECK(jobs == 81);
+    CHECK(timed == 25);
+
+    js.SetTelemetry({true, 8});
+    runLabeled(16);
+    counts(jobs, timed);
+    CHECK(jobs == 97);
+    CHECK(timed == 27);
+
+    // New settings end a capture: switched off it stops at once, and back on it samples at
+    // the set rate, not every job.
+    js.CaptureDetailed(std::chrono::seconds(10));
+    js.SetTelemetry({false, 8});
+    runLabeled(16);
+    counts(jobs, timed);
+    CHECK(jobs == 97);
+    CHECK(timed == 27);
+    js.SetTelemetry({true, 8});
+    runLabeled(16);
+    counts(jobs, timed);
+    CHECK(jobs == 113);
+    CHECK(timed == 29);
+
+    // Only sampled submissions get an id; every job keeps its label.
+    js.Pause();
+    for (int i = 0; i < 16; ++i)
+        js.SubmitLabeled("sampled", [] {});
+    const TracedSystem::Diagnostics d = js.GetDiagnostics();
+    CHECK(d.queuedTasks.size() == 16);
+    size_t withId = 0;
+    for (const TracedSystem::Diagnostics::QueuedTask& t : d.queuedTasks)
+    {
+        withId += (t.id != 0) ? 1 : 0;
+        CHECK(t.label && std::string(t.label) == "sampled");
+    }
+    CHECK(withId == 2);
+    js.Resume();
+    js.WaitIdle();
+}
+
+static void TestLabelRegistry(TestRunner& runner)
+{
+    // Interned by text: a copy of a literal maps to the literal's id, and the name is stable.
+    const std::string copy = "Physics";
+    const core::LabelId physics = core::LabelRegistry::Intern("Physics");
+    CHECK(physics != core::LabelRegistry::kNone);
+    CHECK(core::LabelRegistry::Intern(copy.c_str()) == physics);
+    CHECK(std::string(core::LabelRegistry::Name(physics)) == "Physics");
+    CHECK(core::LabelRegistry::Intern(nullptr) == core::LabelRegistry::kNone);
+    CHECK(core::LabelRegistry::Intern("") == core::LabelRegistry::kNone);
+    CHECK(core::LabelRegistry::Name(core::LabelRegistry::kNone) == nullptr);
+    CHECK(core::LabelRegistry::Intern("(other)") == core::LabelRegistry::kOther);
+    CHECK(core::LabelRegistry::Count() > physics);
+
+    // A reused buffer is interned by its current text, not by the pointer.
+    char buffer[16] = "ReusedA";
+    const core::LabelId reusedA = core::LabelRegistry::Intern(buffer);
+    std::strcpy(buffer, "ReusedB");
+    const core::LabelId reusedB = core::LabelRegistry::Intern(buffer);
+    CHECK(reusedA != reusedB);
+    CHECK(std::string(core::LabelRegistry::Name(reusedB)) == "ReusedB");
+    std::strcpy(buffer, "ReusedA");
+    CHECK(core::LabelRegistry::Intern(buffer) == reusedA);
+
+    auto label = [] { return JOBKIT_LABEL("Physics"); };
+    CHECK(label().id == physics);
+    CHECK(label().id == label().id);
+
+    // Ids, names and copies all land in one histogram row.
+    TracedSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    cfg.telemetry.enabled = true;
+    TracedSystem js(cfg);
+    js.SubmitLabeled(JOBKIT_LABEL("Physics"), [] {});
+    js.SubmitLabeled("Physics", [] {});
+    js.SubmitLabeled(copy.c_str(), [] {});
+    core::JobSystemBase::ParallelForOptions pf{};
+    pf.label = core::Label(physics);
+    pf.grainSize = 1;
+    js.ParallelFor(4, pf, [](size_t, size_t) {});
+    js.WaitIdle();
+
+    const std::vector<core::JobSystemBase::LabelHistogram> histograms = js.GetLabelHistograms();
+    uint64_t count = 0;
+    for (const core::JobSystemBase::LabelHistogram& h : histograms)
+    {
+        CHECK(h.labelId == physics);
+        count += h.count;
+    }
+    CHECK(histograms.size() == 1);
+    CHECK(count >= 3 && count <= 6); // chunks the caller ran itself are not in the histogram
+}
+
+static void TestSyncPrimitives(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    core::JobSystem js(cfg);
+
+    // More waiting jobs than workers: with std::latch both workers would park for good.
+    core::Latch latch(js, 1);
+    std::atomic<int> released{0};
+    for (int i = 0; i < 6; ++i)
+    {
+        js.Submit([&] {
+            latch.Wait();
+            released.fetch_add(1);
+        });
+    }
+    js.Submit([&latch] { latch.CountDown(); });
+    js.WaitIdle();
+    CHECK(released.load() == 6);
+    CHECK(latch.TryWait());
+
+    // One participant per worker, three phases: nobody passes a phase early.
+    core::Barrier barrier(2);
+    std::atomic<int> arrivals[3] = {};
+    std::atomic<int> early{0};
+    for (int p = 0; p < 2; ++p)
+    {
+        js.Submit([&] {
+            for (int phase = 0; phase < 3; ++phase)
+            {
+                arrivals[phase].fetch_add(1);
+                barrier.ArriveAndWait();
+                if (arrivals[phase].load() != 2)
+                    early.fetch_add(1);
+            }
+        });
+    }
+    js.WaitIdle();
+    CHECK(early.load() == 0);
+    CHECK(arrivals[2].load() == 2);
+
+    // The caller parks with nothing to help with until a job sets the event.
+    core::ManualResetEvent ready(js);
+    js.Submit([&ready] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ready.Set();
+    });
+    ready.Wait();
+    CHECK(ready.IsSet());
+    ready.Wait(); // stays set
+    ready.Reset();
+    CHECK(!ready.IsSet());
+
+    std::atomic<int> woken{0};
+    for (int i = 0; i < 3; ++i)
+    {
+        js.Submit([&] {
+            ready.Wait();
+            woken.fetch_add(1);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(woken.load() == 0);
+    ready.Set();
+    js.WaitIdle();
+    CHECK(woken.load() == 3);
+}
+
+static void TestJobMutex(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    core::JobSystem js(cfg);
+
+    // Many short critical sections from many jobs.
+    core::JobMutex mtx(js);
+    uint64_t counter = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        js.Submit([&] {
+            for (int k = 0; k < 100; ++k)
+            {
+                std::lock_guard<core::JobMutex> lock(mtx);
+                ++counter;
+            }
+        });
+    }
+    js.WaitIdle();
+    CHECK(counter == 200 * 100);
+
+    // While one worker holds the lock, the other waits in Lock and runs queued work instead
+    // of idling: the unrelated job finishes before the holder lets go.
+    std::atomic<bool> held{false};
+    std::atomic<bool> waiterStarted{false};
+    std::atomic<bool> otherRan{false};
+    bool otherRanBeforeUnlock = false;
+    js.Submit([&] {
+        mtx.Lock();
+        held.store(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        otherRanBeforeUnlock = otherRan.load();
+        mtx.Unlock();
+    });
+    while (!held.load())
+        std::this_thread::yield();
+    js.Submit([&] {
+        waiterStarted.store(true);
+        std::lock_guard<core::JobMutex> lock(mtx);
+    });
+    while (!waiterStarted.load())
+        std::this_thread::yield();
+    js.Submit([&otherRan] { otherRan.store(true); });
+    js.WaitIdle();
+    CHECK(otherRanBeforeUnlock);
+
+    // Held far past kStarvationNs by an outside thread. The lone worker's waiter turns starving
+    // while it helps, then picks up the second locking job from under the queued fillers: that
+    // job must still be able to wait for the lock on top of it.
+    {
+        core::JobSystem::Config oneCfg{};
+        oneCfg.workerThreads = 1;
+        core::JobSystem one(oneCfg);
+        core::JobMutex starved(one);
+        int locked = 0;
+        std::atomic<bool> firstWaiting{false};
+
+        starved.Lock();
+        one.Submit([&] {
+            firstWaiting.store(true);
+            std::lock_guard<core::JobMutex> lock(starved);
+            ++locked;
+        });
+        while (!firstWaiting.load())
+            std::this_thread::yield();
+        one.Submit([&] {
+            std::lock_guard<core::JobMutex> lock(starved);
+            ++locked;
+        });
+        for (int i = 0; i < 100; ++i)
+            one.Submit([] { std::this_thread::sleep_for(std::chrono::microseconds(100)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        starved.Unlock();
+        one.WaitIdle();
+        CHECK(locked == 2);
+    }
+
+    CHECK(mtx.TryLock());
+    CHECK(!mtx.TryLock());
+    mtx.Unlock();
+}
+
+static void TestLocalQueues(TestRunner& runner)
+{
+    // One worker: children spawned by a job run on that worker, newest first.
+    {
+        core::JobSystem::Config cfg{};
+        cfg.workerThreads = 1;
+        core::JobSystem js(cfg);
+
+        std::mutex mtx;
+        std::vector<int> order;
+        js.Submit([&] {
+            for (int i = 0; i < 8; ++i)
+            {
+                js.Submit([&, i] {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    order.push_back(i);
+                });
+            }
+        });
+        js.WaitIdle();
+        CHECK(order == std::vector<int>({7, 6, 5, 4, 3, 2, 1, 0}));
+    }
+
+    // Two workers, the owner stays busy: the other worker steals from the cold end, oldest first.
+    {
+        core::JobSystem::Config cfg{};
+        cfg.workerThreads = 2;
+        core::JobSystem js(cfg);
+
+        std::mutex mtx;
+        std::vector<int> order;
+        std::atomic<int> done{0};
+        std::atomic<uint32_t> owner{core::ThreadPool::kNotAWorker};
+        bool stolen = true;
+        js.Submit([&] {
+            owner.store(js.Pool().CurrentWorkerIndex());
+            for (int i = 0; i < 8; ++i)
+            {
+                js.Submit([&, i] {
+                    {
+                        std::lock_guard<std::mutex> lock(mtx);
+                        order.push_back(i);
+                        stolen = stolen && js.Pool().CurrentWorkerIndex() != owner.load();
+                    }
+                    done.fetch_add(1);
+                });
+            }
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (done.load() < 8 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+        });
+        js.WaitIdle();
+        CHECK(stolen);
+        CHECK(order == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7}));
+    }
+}
+
+static void TestSharedPool(TestRunner& runner)
+{
+    core::ThreadPool::Config poolCfg{};
+    poolCfg.workerThreads = 3;
+    auto pool = std::make_shared<core::ThreadPool>(poolCfg);
+
+    core::JobSystem::Config cfg{};
+    cfg.pool = pool;
+
+    core::JobSystem a(cfg);
+    core::JobSystem b(cfg);
+    CHECK(a.GetStats().workerCount == 3);
+    CHECK(b.GetStats().workerCount == 3);
+
+    // Both front-ends are served by the same three threads; each counts only its own work.
+    std::atomic<int> countA{0};
+    std::atomic<int> countB{0};
+    constexpr int kTasks = 50;
+    for (int i = 0; i < kTasks; ++i)
+    {
+        CHECK(a.Submit([&countA] { countA.fetch_add(1, std::memory_order_relaxed); }));
+        CHECK(b.Submit([&countB] { countB.fetch_add(1, std::memory_order_relaxed); }));
+    }
+
+    a.WaitIdle();
+    CHECK(countA.load(std::memory_order_relaxed) == kTasks);
+    b.WaitIdle();
+    CHECK(countB.load(std::memory_order_relaxed) == kTasks);
+
+    CHECK(a.GetStats().submitted == static_cast<uint64_t>(kTasks));
+    CHECK(b.GetStats().completed == static_cast<uint64_t>(kTasks));
+
+    // Stopping one front-end leaves the pool serving the other.
+    a.Stop();
+    CHECK(!a.Submit([] {}));
+    CHECK(a.GetStats().workerCount == 0);
+
+    std::atomic<bool> ran{false};
+    CHECK(b.Submit([&ran] { ran.store(true, std::memory_order_relaxed); }));
+    b.WaitIdle();
+    CHECK(ran.load(std::memory_order_relaxed));
+    CHECK(pool->WorkerCount() == 3);
+}
+
+static void TestPauseResume(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    core::JobSystem js(cfg);
+
+    std::atomic<int> count{0};
+    std::atomic<bool> started{false};
+    CHECK(js.Submit([&] {
+        started.store(true, std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        count.fetch_add(1, std::memory_order_relaxed);
+    }));
+    while (!started.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+
+    // Pause waits for the in-flight job, then holds back new work.
+    js.Pause();
+    CHECK(js.GetStats().inFlight == 0);
+    CHECK(count.load(std::memory_order_relaxed) == 1);
+
+    constexpr int kQueued = 10;
+    for (int i = 0; i < kQueued; ++i)
+    {
+        CHECK(js.Submit([&count] {
+            count.fetch_add(1, std::memory_order_relaxed);
+        }));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const core::JobSystem::Stats paused = js.GetStats();
+    CHECK(paused.paused);
+    CHECK(paused.queued == static_cast<uint64_t>(kQueued));
+    CHECK(paused.workerCount == 2);
+    CHECK(count.load(std::memory_order_relaxed) == 1);
+
+    js.Resume();
+    js.WaitIdle();
+    CHECK(!js.GetStats().paused);
+    CHECK(count.load(std::memory_order_relaxed) == kQueued + 1);
+
+    // A running job that waits on children it submits after the pause still finishes, so
+    // Pause returns.
+    std::atomic<bool> parentStarted{false};
+    std::atomic<int> children{0};
+    core::JobSystem::ParallelForOptions pf{};
+    pf.grainSize = 1;
+    CHECK(js.Submit([&] {
+        parentStarted.store(true);
+        while (!js.GetStats().paused)
+            std::this_thread::yield();
+        js.Wait(js.Submit([&children] { children.fetch_add(1); }));
+        js.ParallelFor(8, pf, [&children](size_t, size_t) {
+            children.fetch_add(1);
+        });
+    }));
+    while (!parentStarted.load())
+        std::this_thread::yield();
+    js.Pause();
+    CHECK(js.GetStats().inFlight == 0);
+    CHECK(children.load() == 9);
+    js.Resume();
+
+    // Stop drains paused work.
+    js.Pause();
+    CHECK(js.Submit([&count] {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }));
+    js.Stop();
+    CHECK(count.load(std::memory_order_relaxed) == kQueued + 2);
+
+    // Submitting while paused wakes no one: a lazy pool starts no workers until Resume.
+    core::JobSystem::Config lazyCfg{};
+    lazyCfg.workerThreads = 2;
+    lazyCfg.lazyStart = true;
+    core::JobSystem lazy(lazyCfg);
+    lazy.Pause();
+    std::atomic<int> lazyRan{0};
+    for (int i = 0; i < 8; ++i)
+        CHECK(lazy.Submit([&lazyRan] { lazyRan.fetch_add(1); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(lazy.GetStats().startedWorkers == 0);
+    CHECK(lazyRan.load() == 0);
+    lazy.Resume();
+    lazy.WaitIdle();
+    CHECK(lazyRan.load() == 8);
+    CHECK(lazy.GetStats().startedWorkers >= 1);
+}
+
+static void TestLazyStart(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 4;
+    cfg.lazyStart = true;
+    core::JobSystem js(cfg);
+
+    CHECK(js.GetStats().workerCount == 4);
+    CHECK(js.GetStats().startedWorkers == 0);
+
+    std::atomic<int> count{0};
+    CHECK(js.Submit([&count] { count.fetch_add(1, std::memory_order_relaxed); }));
+    CHECK(js.GetStats().startedWorkers == 1);
+    js.WaitIdle();
+    CHECK(count.load(std::memory_order_relaxed) == 1);
+
+    // A backlog of blocked jobs grows the pool up to the configured count, never beyond.
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool release = false;
+    for (int i = 0; i < 8; ++i)
+    {
+        CHECK(js.Submit([&] {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return release; });
+            count.fetch_add(1, std::memory_order_relaxed);
+        }));
+    }
+    CHECK(js.GetStats().startedWorkers > 1);
+    CHECK(js.GetStats().startedWorkers <= 4);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        release = true;
+    }
+    cv.notify_all();
+    js.WaitIdle();
+    CHECK(count.load(std::memory_order_relaxed) == 9);
+}
+
+static void TestHighCapacityHint(TestRunner& runner)
+{
+    // A simulated big.LITTLE pair: worker 0 lands on the big core, worker 1 on the little one.
+    auto topo = std::make_shared<core::CpuTopology>();
+    topo->cpus.resize(2);
+    topo->cpus[0].cpu = 0;
+    topo->cpus[1].cpu = 1;
+    topo->cpus[1].core = 1;
+    topo->cpus[1].l3 = 0;
+    topo->cpus[1].capacity = 512;
+    topo->physicalCores = 2;
+
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    cfg.pinWorkers = true;
+    cfg.topology = topo;
+    core::JobSystem js(cfg);
+    CHECK(js.Pool().IsHighCapacityWorker(0));
+    CHECK(!js.Pool().IsHighCapacityWorker(1));
+
+    core::JobSystem::SubmitOptions hot{};
+    hot.label = "Hot";
+    hot.cores = core::JobSystem::CoreHint::HighCapacity;
+
+    // Queue both kinds while paused, so each worker picks from a full set of lanes.
+    std::mutex mtx;
+    std::vector<bool> ranHot[2];
+    auto job = [&](bool isHot) {
+        return [&, isHot] {
+            const std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+            while (std::chrono::steady_clock::now() < until)
+            {
+            }
+            const uint32_t w = js.Pool().CurrentWorkerIndex();
+            std::lock_guard<std::mutex> lock(mtx);
+            if (w < 2)
+                ranHot[w].push_back(isHot);
+        };
+    };
+
+    js.Pause();
+    for (int i = 0; i < 20; ++i)
+    {
+        CHECK(js.Submit(hot, job(true)));
+        CHECK(js.Submit(job(false)));
+    }
+    js.Resume();
+    js.WaitIdle();
+
+    // The big worker drains HighCapacity jobs before touching the rest; the little worker
+    // does the opposite. Each worker's run order is therefore one block, then the other.
+    const std::vector<bool>& big = ranHot[0];
+    const std::vector<bool>& little = ranHot[1];
+    CHECK(big.size() + little.size() == 40);
+    CHECK(std::is_sorted(big.begin(), big.end(), std::greater<bool>()));
+    CHECK(std::is_sorted(little.begin(), little.end()));
+    CHECK(big.empty() || big.front());
+    CHECK(little.empty() || !little.front());
+    CHECK(js.GetStats().queued == 0);
+}
+
+static void TestStealOrder(TestRunner& runner)
+{
+    // cpu0/cpu1 are SMT siblings, cpu2 shares their L3, cpu3 only their NUMA node, cpu4 is remote.
+    auto topo = std::make_shared<core::CpuTopology>();
+    const uint32_t cores[5] = {0, 0, 2, 3, 4};
+    const uint32_t l3s[5] = {0, 0, 0, 3, 4};
+    const uint32_t nodes[5] = {0, 0, 0, 0, 1};
+    for (uint32_t cpu = 0; cpu < 5; ++cpu)
+    {
+        core::CpuInfo c{};
+        c.cpu = cpu;
+        c.core = cores[cpu];
+        c.l3 = l3s[cpu];
+        c.numaNode = nodes[cpu];
+        c.smtPrimary = (cpu != 1);
+        topo->cpus.push_back(c);
+    }
+    topo->physicalCores = 4;
+
+    core::ThreadPool::Config cfg{};
+    cfg.workerThreads = 5;
+    cfg.pinWorkers = true;
+    cfg.topology = topo;
+    core::ThreadPool pool(cfg);
+
+    const std::vector<uint32_t> placement = core::PlanWorkerPlacement(*topo, 5);
+    uint32_t workerOn[5] = {};
+    for (uint32_t w = 0; w < 5; ++w)
+        workerOn[placement[w]] = w;
+
+    const std::span<const uint32_t> order = pool.StealOrder(workerOn[0]);
+    CHECK(std::vector<uint32_t>(order.begin(), order.end()) ==
+          std::vector<uint32_t>({workerOn[1], workerOn[2], workerOn[3], workerOn[4]}));
+    CHECK(pool.NearVictimCount(workerOn[0]) == 2);
+    CHECK(pool.NearVictimCount(workerOn[4]) == 0);
+
+    // Remote work is still taken once the near attempts run out.
+    core::JobSystem::Config jsCfg{};
+    jsCfg.pool = std::make_shared<core::ThreadPool>(cfg);
+    core::JobSystem js(jsCfg);
+    std::atomic<int> ran{0};
+    js.Submit([&] {
+        for (int i = 0; i < 32; ++i)
+            js.Submit([&ran] { ran.fetch_add(1); });
+        while (ran.load() < 32)
+            std::this_thread::yield(); // the owner never gets to its own children
+    });
+    js.WaitIdle();
+    CHECK(ran.load() == 32);
+}
+
+static thread_local int t_workerContext = -1;
+
+static void TestWorkerHooks(TestRunner& runner)
+{
+    std::atomic<int> started{0};
+    std::atomic<int> stopped{0};
+    std::atomic<size_t> stackBytes{0};
+    std::mutex namesMtx;
+    std::vector<std::string> names;
+
+    {
+        core::JobSystem::Config cfg{};
+        cfg.workerThreads = 2;
+        cfg.hooks.stackSize = 256 * 1024;
+        cfg.hooks.namePrefix = "jk-test";
+        cfg.hooks.onStart = [&](uint32_t workerIndex) {
+            t_workerContext = (int)workerIndex;
+            started.fetch_add(1, std::memory_order_relaxed);
+#if defined(__linux__)
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            std::lock_guard<std::mutex> lock(namesMtx);
+            names.push_back(name);
+
+            pthread_attr_t attr;
+            size_t size = 0;
+            if (pthread_getattr_np(pthread_self(), &attr) == 0)
+            {
+                pthread_attr_getstacksize(&attr, &size);
+                pthread_attr_destroy(&attr);
+            }
+            stackBytes.store(size, std::memory_order_relaxed);
+#endif
+        };
+        cfg.hooks.onStop = [&](uint32_t) { stopped.fetch_add(1, std::memory_order_relaxed); };
+        core::JobSystem js(cfg);
+
+        // Thread-local state set up by onStart is visible to the jobs.
+        std::atomic<int> sawContext{0};
+        for (int i = 0; i < 20; ++i)
+        {
+            CHECK(js.Submit([&sawContext] {
+                if (t_workerContext >= 0)
+                    sawContext.fetch_add(1, std::memory_order_relaxed);
+            }));
+        }
+        js.WaitIdle();
+        CHECK(sawContext.load(std::memory_order_relaxed) == 20);
+    }
+
+    CHECK(started.load(std::memory_order_relaxed) == 2);
+    CHECK(stopped.load(std::memory_order_relaxed) == 2);
+#if defined(__linux__)
+    std::sort(names.begin(), names.end());
+    CHECK(names == std::vector<std::string>({"jk-test-0", "jk-test-1"}));
+    CHECK(stackBytes.load(std::memory_order_relaxed) >= 256 * 1024);
+    CHECK(stackBytes.load(std::memory_order_relaxed) < 1024 * 1024);
+#endif
+}
+
+#if !defined(_WIN32)
+static void TestJobserverLimitsParallelism(TestRunner& runner)
+{
+    int fds[2] = {-1, -1};
+    CHECK(pipe(fds) == 0);
+
+    // make -j2: one implicit slot plus one token in the pipe.
+    CHECK(write(fds[1], "+", 1) == 1);
+
+    const char* oldFlags = std::getenv("MAKEFLAGS");
+    const std::string saved = oldFlags ? oldFlags : "";
+    const std::string flags = " -j2 --jobserver-auth=" + std::to_string(fds[0]) + "," + std::to_string(fds[1]);
+    setenv("MAKEFLAGS", flags.c_str(), 1);
+
+    {
+        core::JobSystem::Config cfg{};
+        cfg.workerThreads = 4;
+        cfg.useJobserver = true;
+        core::JobSystem js(cfg);
+
+        std::atomic<int> running{0};
+        std::atomic<int> peak{0};
+        for (int i = 0; i < 24; ++i)
+        {
+            CHECK(js.Submit([&] {
+                const int now = running.fetch_add(1, std::memory_order_acq_rel) + 1;
+                int prev = peak.load(std::memory_order_relaxed);
+                while (now > prev && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed))
+                {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                running.fetch_sub(1, std::memory_order_acq_rel);
+            }));
+        }
+        js.WaitIdle();
+
+        CHECK(peak.load(std::memory_order_relaxed) >= 1);
+        CHECK(peak.load(std::memory_order_relaxed) <= 2);
+    }
+
+    // The token is back in the pipe once the workers are gone.
+    pollfd pfd{fds[0], POLLIN, 0};
+    CHECK(poll(&pfd, 1, 0) == 1);
+
+    if (oldFlags)
+        setenv("MAKEFLAGS", saved.c_str(), 1);
+    else
+        unsetenv("MAKEFLAGS");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+#if !defined(_WIN32)
+static void TestRealtimeDispatchUnderLoad(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 3;
+    cfg.realtimeWorkers = 1;
+    cfg.realtimePolicy = core::ThreadPool::RealtimePolicy::Fifo;
+    cfg.realtimePriority = 20;
+    core::JobSystem js(cfg);
+
+    // A CPU hog per hardware thread beside the pool, and both ordinary workers busy with long
+    // jobs: every core has more runnable threads than it can serve.
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> hogs;
+    const unsigned hogCount = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned i = 0; i < hogCount; ++i)
+    {
+        hogs.emplace_back([&stop] {
+            while (!stop.load(std::memory_order_relaxed))
+            {
+            }
+        });
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        CHECK(js.Submit([&stop] {
+            while (!stop.load(std::memory_order_relaxed))
+                std::this_thread::yield();
+        }));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    constexpr int kSamples = 200;
+    std::vector<int64_t> latencyNs;
+    bool submitterRealtime = false;
+    int rejected = 0;
+
+    // Results are gathered here and checked on the main thread once the producer is joined.
+
+    // Latency-critical producers (an audio callback, say) are realtime threads themselves;
+    // otherwise the hogs could delay the producer between timestamp and Submit.
+    std::thread producer([&] {
+        sched_param param{};
+        param.sched_priority = cfg.realtimePriority;
+        submitterRealtime = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+
+        core::JobSystem::SubmitOptions opts{};
+        opts.label = "Audio";
+        opts.priority = core::JobSystem::Priority::Realtime;
+
+        for (int i = 0; i < kSamples; ++i)
+        {
+            std::atomic<int64_t> startedNs{0};
+            const Clock::time_point submitted = Clock::now();
+            const core::JobSystem::JobHandle h = js.Submit(opts, [&startedNs, submitted] {
+                startedNs.store(std::max<int64_t>((Clock::now() - submitted).count(), 1), std::memory_order_release);
+                startedNs.notify_one();
+            });
+            if (!h)
+            {
+                ++rejected;
+                continue;
+            }
+
+            startedNs.wait(0, std::memory_order_acquire);
+            latencyNs.push_back(startedNs.load(std::memory_order_acquire));
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    producer.join();
+
+    stop.store(true, std::memory_order_relaxed);
+    for (std::thread& t : hogs)
+        t.join();
+    js.WaitIdle();
+
+    CHECK(rejected == 0);
+    CHECK((int)latencyNs.size() == kSamples);
+    CHECK(js.GetStats().completed == kSamples + 2);
+
+    // With realtime privileges the realtime worker must start each job within 1ms. Without
+    // them neither thread can leave the normal class, so latency is up to the fair scheduler:
+    // only a loose bound holds, and the run says the real bound went unchecked.
+    std::sort(latencyNs.begin(), latencyNs.end());
+    const int64_t p95 = latencyNs.empty() ? 0 : latencyNs[latencyNs.size() * 95 / 100];
+    CHECK(p95 < 50000000);
+    if (submitterRealtime && js.GetStats().realtimeWorkersApplied == 1)
+        CHECK(p95 < 1000000);
+    else
+        std::cout << "NOTE TestRealtimeDispatchUnderLoad: no SCHED_FIFO (needs CAP_SYS_NICE or RLIMIT_RTPRIO), "
+                  << "1 ms dispatch bound not checked; p95 " << p95 / 1000 << " us with " << hogCount << " hogs\n";
+}
+#endif
+
+static void TestMetricsExport(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    cfg.telemetry.enabled = true;
+    core::JobSystem js(cfg);
+
+    for (int i = 0; i < 10; ++i)
+        js.SubmitLabeled("Physics \"step\"", [] { std::this_thread::sleep_for(std::chrono::microseconds(50)); });
+    js.WaitIdle();
+
+    core::MetricsOptions opts;
+    opts.system = "main";
+    const std::string text = core::RenderOpenMetrics(js, opts);
+    CHECK(text.find("# TYPE jobkit_jobs_submitted counter\n") != std::string::npos);
+    CHECK(text.find("jobkit_jobs_submitted_total{system=\"main\"} 10\n") != std::string::npos);
+    CHECK(text.find("jobkit_jobs_queued{system=\"main\"} 0\n") != std::string::npos);
+    CHECK(text.size() >= 6 && text.compare(text.size() - 6, 6, "# EOF\n") == 0);
+
+    CHECK(text.find("jobkit_worker_busy_seconds_total{system=\"main\",worker=\"1\"} ") != std::string::npos);
+    const std::string label = "label=\"Physics \\\"step\\\"\"";
+    CHECK(text.find("jobkit_job_duration_seconds_bucket{system=\"main\"," + label + ",le=\"1e-05\"} 0\n") != std::string::npos);
+    CHECK(text.find("jobkit_job_duration_seconds_bucket{system=\"main\"," + label + ",le=\"+Inf\"} 10\n") != std::string::npos);
+    CHECK(text.find("jobkit_job_duration_seconds_count{system=\"main\"," + label + "} 10\n") != std::string::npos);
+
+    const std::vector<core::JobSystem::LabelHistogram> h = js.GetLabelHistograms();
+    CHECK(h.size() == 1 && h[0].count == 10 && h[0].sumNs >= 500'000);
+
+    // Any configuration renders; without telemetry the worker and label families stay empty.
+    core::JobSystem::Config bareCfg{};
+    bareCfg.workerThreads = 1;
+    SharedSpinSystem bare(bareCfg);
+    CHECK(bare.Submit([] {}));
+    bare.WaitIdle();
+    const std::string bareText = core::RenderOpenMetrics(bare);
+    CHECK(bareText.find("jobkit_jobs_completed_total 1\n") != std::string::npos);
+    CHECK(bareText.find("jobkit_telemetry_sample_every 0\n") != std::string::npos);
+    CHECK(bareText.find("worker=") == std::string::npos);
+
+    // Periodic export to a callback and a textfile.
+    const std::string path = "jobkit_metrics_test.prom";
+    std::atomic<int> calls{0};
+    {
+        core::MetricsExporter::Config ec{};
+        ec.interval = std::chrono::milliseconds(5);
+        ec.textfilePath = path;
+        ec.callback = [&calls](const std::string& t) {
+            if (t.find("# EOF") != std::string::npos)
+                calls.fetch_add(1);
+        };
+        core::MetricsExporter exporter(js, ec);
+        while (calls.load() < 2)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        CHECK(exporter.ExportNow());
+    }
+    const int after = calls.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(calls.load() == after); // stopped with the exporter
+
+    FILE* f = std::fopen(path.c_str(), "rb");
+    CHECK(f != nullptr);
+    if (f)
+    {
+        char buf[64] = {};
+        CHECK(std::fread(buf, 1, sizeof(buf) - 1, f) > 0);
+        CHECK(std::string(buf).rfind("# TYPE jobkit_workers gauge", 0) == 0);
+        std::fclose(f);
+    }
+    std::remove(path.c_str());
+
+    // Scrapes keep going while the system stops, and keep reporting its workers after.
+    std::atomic<bool> scraping{true};
+    std::atomic<int> scrapes{0};
+    std::thread scraper([&] {
+        while (scraping.load())
+        {
+            if (core::RenderOpenMetrics(js).find("worker=\"1\"") != std::string::npos)
+                scrapes.fetch_add(1);
+        }
+    });
+    while (scrapes.load() < 2)
+        std::this_thread::yield();
+    for (int i = 0; i < 100; ++i)
+        js.SubmitLabeled("Physics \"step\"", [] {});
+    js.Stop();
+    const int atStop = scrapes.load();
+    while (scrapes.load() < atStop + 2)
+        std::this_thread::yield();
+    scraping.store(false);
+    scraper.join();
+    CHECK(js.GetWorkerDiagnostics().size() == 2);
+}
+
+static void TestWorkerCounters(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    cfg.telemetry.enabled = true;
+    core::JobSystem js(cfg);
+
+    // Let both workers park, then wake them with a job that spawns children and stays busy,
+    // so the other worker has to steal them.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::atomic<int> ran{0};
+    js.Submit([&] {
+        for (int i = 0; i < 16; ++i)
+            js.Submit([&ran] { ran.fetch_add(1); });
+        while (ran.load() < 16)
+            std::this_thread::yield();
+    });
+    js.WaitIdle();
+
+    const core::JobSystem::Diagnostics d = js.GetDiagnostics();
+    CHECK(d.workers.size() == 2);
+    uint64_t jobs = 0, busy = 0, steals = 0, parked = 0, wakeups = 0, spurious = 0;
+    for (const core::JobSystem::Diagnostics::Worker& w : d.workers)
+    {
+        jobs += w.jobsExecuted;
+        busy += w.busyNs;
+        steals += w.steals;
+        parked += w.parkedNs;
+        wakeups += w.wakeups;
+        spurious += w.spuriousWakeups;
+    }
+    CHECK(jobs == 17);
+    CHECK(busy > 0);
+    CHECK(steals == 16);
+    CHECK(parked >= 10'000'000); // both slept through most of the initial 20 ms
+    CHECK(wakeups >= 1);
+    CHECK(spurious <= wakeups);
+
+    // Switched off, the pool's counters hold still.
+    auto poolCounters = [&js] {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            const core::ThreadPool::WorkerCounters c = js.Pool().GetWorkerCounters(i);
+            sum += c.parkedNs + c.wakeups + c.spinNs + c.spuriousWakeups;
+        }
+        return sum;
+    };
+    js.SetTelemetry({false, 1});
+    for (int i = 0; i < 4; ++i)
+        js.Submit([] {});
+    js.WaitIdle();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const uint64_t frozen = poolCounters();
+    for (int i = 0; i < 4; ++i)
+        js.Submit([] {});
+    js.WaitIdle();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(poolCounters() == frozen);
+}
+
+static void TestStallWatchdog(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 1;
+    cfg.telemetry.enabled = true;
+    core::JobSystem js(cfg);
+
+    std::mutex mtx;
+    std::vector<core::StallWatchdog::Stall> stalls;
+    uint64_t starved = 0;
+
+    core::StallWatchdog::Config wc{};
+    wc.interval = std::chrono::milliseconds(2);
+    wc.budgetsNs = {{"Slow", 5'000'000}, {"Unbounded", 0}};
+    wc.defaultBudgetNs = 1'000'000'000;
+    wc.starvationNs = 10'000'000;
+    wc.onStall = [&](const core::StallWatchdog::Stall& s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        stalls.push_back(s);
+    };
+    wc.onStarvation = [&](const core::JobSystem::QueueAges& a) {
+        std::lock_guard<std::mutex> lock(mtx);
+        starved = std::max(starved, a.olderThan);
+    };
+    core::StallWatchdog watchdog(js, wc);
+
+    // The slow job holds the only worker, so the quick one queues behind it.
+    js.SubmitLabeled("Unbounded", [] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+    js.SubmitLabeled("Slow", [] { std::this_thread::sleep_for(std::chrono::milliseconds(40)); });
+    js.SubmitLabeled("Quick", [] {});
+    js.WaitIdle();
+    watchdog.SampleNow();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        CHECK(stalls.size() == 1); // once per job, and Unbounded has no budget
+        if (!stalls.empty())
+        {
+            CHECK(std::string(stalls[0].label) == "Slow");
+            CHECK(stalls[0].runningNs > stalls[0].budgetNs);
+            CHECK(stalls[0].budgetNs == 5'000'000);
+        }
+        CHECK(starved >= 1);
+    }
+    CHECK(watchdog.StallCount() == 1);
+    CHECK(watchdog.StarvedJobs() == 0); // queues empty at the last sample
+
+    // Stopping under a live watchdog: it goes on sampling the stopped system.
+    js.SubmitLabeled("Quick", [] { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+    js.Stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    watchdog.SampleNow();
+    CHECK(watchdog.StallCount() == 1);
+}
+
+static void TestRecording(TestRunner& runner)
+{
+    core::JobSystem::Config cfg{};
+    cfg.workerThreads = 2;
+    cfg.telemetry.enabled = true;
+
+    core::JobSystem js(cfg);
+    CHECK(js.StartRecording());
+    CHECK(!js.StartRecording());
+
+    CHECK(js.SubmitLabeled("Parent", [&js] {
+        js.SubmitLabeled("Child", [] {});
+    }));
+    js.WaitIdle();
+
+    const core::JobSystem::JobHandle gate = js.SubmitLabeled("Gate", [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+    core::JobSystem::SubmitOptions nextOpts{};
+    nextOpts.label = "NextFrame";
+    nextOpts.dependsOn = std::span(&gate, 1);
+    CHECK(js.Submit(nextOpts, [] {}));
+    js.WaitIdle();
+
+    const core::ScheduleTrace trace = js.StopRecording();
+    CHECK(trace.workerCount == 2);
+    CHECK(trace.records.size() == 4);
+    if (trace.records.size() != 4)
+        return;
+
+    const core::ScheduleRecord& parent = trace.records[0];
+    const core::ScheduleRecord& child = trace.records[1];
+    const core::ScheduleRecord& gated = trace.records[2];
+    const core::ScheduleRecord& next = trace.records[3];
+
+    CHECK(trace.labels[parent.labelIndex] == "Parent");
+    CHECK(trace.labels[child.labelIndex] == "Child");
+    CHECK(parent.parentId == 0);
+    CHECK(child.parentId == parent.id);
+    CHECK(child.epoch == parent.epoch);
+    CHECK(next.epoch == parent.epoch + 1);
+    CHECK(child.submitNs >= parent.startNs);
+    CHECK(next.startNs >= child.startNs + child.durationNs);
+    CHECK(next.dependencies == std::vector<uint64_t>({gated.id}));
+    CHECK(next.startNs >= gated.startNs + gated.durationNs);
+
+    CHECK(js.StopRecording().records.empty());
+
+    const std::vector<core::CriticalPathReport> frames = core::AnalyzeCriticalPaths(trace);
+    CHECK(frames.size() == 2);
+    if (frames.size() == 2)
+    {
+        CHECK(frames[0].jobCount == 2);
+        CHECK(frames[0].labels.size() >= 1 && frames[0].labels[0] == "Parent");
+        CHECK(frames[1].labels == std::vector<std::string>({"Gate", "NextFrame"}));
+    }
+
+    // One worker: the parent runs its 20 ms child itself while waiting. Only the child's time
+    // is work; counting it in the parent too would double the frame.
+    core::JobSystem::Config oneCfg{};
+    oneCfg.workerThreads = 1;
+    core::JobSystem single(oneCfg);
+    CHECK(single.StartRecording());
+    single.SubmitLabeled("Parent", [&single] {
+        single.Wait(single.SubmitLabeled("Child", [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }));
+    });
+    single.WaitIdle();
+
+    const core::ScheduleTrace nested = single.StopRecording();
+    CHECK(nested.records.size() == 2);
+    if (nested.records.size() != 2)
+        return;
+    CHECK(nested.records[0].durationNs < 10'000'000);
+    CHECK(nested.records[1].durationNs >= 20'000'000);
+
+    const std::vector<core::CriticalPathReport> nestedFrames = core::AnalyzeCriticalPaths(nested);
+    CHECK(nestedFrames.size() == 1);
+    if (nestedFrames.size() == 1)
+        CHECK(nestedFrames[0].totalWorkNs < 30'000'000);
+
+    // Two workers: the other worker takes the child, and the parent blocks in Wait. The time
+    // it waits is no more its own than when it ran the child itself.
+    CHECK(js.StartRecording());
+    js.SubmitLabeled("Parent", [&js] {
+        std::atomic<bool> started{false};
+        const core::JobSystem::JobHandle child = js.SubmitLabeled("Child", [&started] {
+            started.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        while (!started.load())
+            std::this_thread::yield();
+        js.Wait(child);
+    });
+    js.WaitIdle();
+
+    const core::ScheduleTrace stolen = js.StopRecording();
+    CHECK(stolen.records.size() == 2);
+    if (stolen.records.size() != 2)
+        return;
+    CHECK(stolen.records[0].worker != stolen.records[1].worker);
+    CHECK(stolen.records[0].durationNs < 10'000'000);
+    CHECK(stolen.records[1].durationNs >= 20'000'000);
+
+    const std::vector<core::CriticalPathReport> stolenFrames = core::AnalyzeCriticalPaths(stolen);
+    CHECK(stolenFrames.size() == 1);
+    if (stolenFrames.size() == 1)
+        CHECK(stolenFrames[0].totalWorkNs < 30'000'000);
+}
+
 int main()
 {
     TestRunner runner;
@@ -130,6 +1763,33 @@ int main()
     TestBasicSubmit(runner);
     TestCancelPending(runner);
     TestRejectEmpty(runner);
+    TestTaskStorage(runner);
+    TestJobHandles(runner);
+    TestParallelForAligned(runner);
+    TestNestedParallelism(runner);
+    TestWorkerLocal(runner);
+    TestSyncPrimitives(runner);
+    TestJobMutex(runner);
+    TestLocalQueues(runner);
+    TestSharedPool(runner);
+    TestPolicies(runner);
+    TestTelemetrySampling(runner);
+    TestLabelRegistry(runner);
+    TestPauseResume(runner);
+    TestLazyStart(runner);
+    TestHighCapacityHint(runner);
+    TestStealOrder(runner);
+    TestWorkerHooks(runner);
+    TestMetricsExport(runner);
+
+#if !defined(_WIN32)
+    TestJobserverLimitsParallelism(runner);
+    TestRealtimeDispatchUnderLoad(runner);
+#endif
+
+    TestWorkerCounters(runner);
+    TestStallWatchdog(runner);
+    TestRecording(runner);
 
     return runner.Finish();
 }
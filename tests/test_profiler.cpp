@@ -0,0 +1,47 @@
+#include "JobSystem.h"
+#include "TestRunner.h"
+
+#include JOBKIT_PROFILER_HEADER
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static void TestProfilerHooks(TestRunner& runner)
+{
+    jobkit_test::ProfileCounts& p = jobkit_test::g_profile;
+    {
+        core::JobSystem::Config cfg{};
+        cfg.workerThreads = 2;
+        core::JobSystem js(cfg);
+
+        // Let both workers park, then spawn children from a job that stays busy, so the
+        // other worker wakes up and steals them.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::atomic<int> ran{0};
+        js.SubmitLabeled("Parent", [&] {
+            for (int i = 0; i < 8; ++i)
+                js.Submit([&ran] { ran.fetch_add(1); });
+            while (ran.load() < 8)
+                std::this_thread::yield();
+        });
+        js.WaitIdle();
+    }
+
+    CHECK(p.submits.load() == 9);
+    CHECK(p.labelledSubmits.load() == 1);
+    CHECK(p.begins.load() == 9);
+    CHECK(p.ends.load() == 9);
+    CHECK(p.steals.load() == 8);
+    CHECK(p.parks.load() >= 2);
+    CHECK(p.unparks.load() == p.parks.load()); // every worker woke up again for shutdown
+}
+
+int main()
+{
+    TestRunner runner;
+
+    TestProfilerHooks(runner);
+
+    return runner.Finish();
+}
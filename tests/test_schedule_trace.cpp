@@ -0,0 +1,158 @@
+#include "ScheduleTrace.h"
+#include "TestRunner.h"
+
+#include <cstdio>
+#include <string>
+
+static core::ScheduleRecord MakeRecord(uint64_t id, uint64_t parent, uint32_t epoch, int64_t submitNs, int64_t startNs, int64_t durationNs)
+{
+    core::ScheduleRecord r{};
+    r.id = id;
+    r.parentId = parent;
+    r.epoch = epoch;
+    r.submitNs = submitNs;
+    r.startNs = startNs;
+    r.durationNs = durationNs;
+    return r;
+}
+
+// Four independent 10 ms jobs followed (next epoch) by one 5 ms job.
+static core::ScheduleTrace MakeFanOutTrace()
+{
+    core::ScheduleTrace t{};
+    t.workerCount = 2;
+    t.labels.push_back("Work");
+    t.labels.push_back("Tail");
+
+    for (uint64_t i = 1; i <= 4; ++i)
+    {
+        core::ScheduleRecord r = MakeRecord(i, 0, 0, 0, ((i - 1) / 2) * 10'000'000, 10'000'000);
+        r.labelIndex = 1;
+        t.records.push_back(r);
+    }
+
+    core::ScheduleRecord tail = MakeRecord(5, 0, 1, 20'000'000, 20'000'000, 5'000'000);
+    tail.labelIndex = 2;
+    t.records.push_back(tail);
+    return t;
+}
+
+static void TestSaveLoadRoundTrip(TestRunner& runner)
+{
+    core::ScheduleTrace t = MakeFanOutTrace();
+    t.records[4].dependencies = {2, 3};
+    t.records[1].parentId = 1;
+    t.records[3].worker = 1;
+
+    const std::string path = "jobkit_trace_roundtrip.bin";
+    CHECK(core::SaveScheduleTrace(t, path.c_str()));
+
+    core::ScheduleTrace loaded{};
+    CHECK(core::LoadScheduleTrace(path.c_str(), loaded));
+    std::remove(path.c_str());
+
+    CHECK(loaded.workerCount == t.workerCount);
+    CHECK(loaded.labels == t.labels);
+    CHECK(loaded.records.size() == t.records.size());
+    for (size_t i = 0; i < loaded.records.size() && i < t.records.size(); ++i)
+    {
+        const core::ScheduleRecord& a = loaded.records[i];
+        const core::ScheduleRecord& b = t.records[i];
+        CHECK(a.id == b.id);
+        CHECK(a.parentId == b.parentId);
+        CHECK(a.labelIndex == b.labelIndex);
+        CHECK(a.epoch == b.epoch);
+        CHECK(a.worker == b.worker);
+        CHECK(a.submitNs == b.submitNs);
+        CHECK(a.startNs == b.startNs);
+        CHECK(a.durationNs == b.durationNs);
+        CHECK(a.dependencies == b.dependencies);
+    }
+
+    core::ScheduleTrace bad{};
+    CHECK(!core::LoadScheduleTrace("jobkit_trace_missing.bin", bad));
+}
+
+static void TestSimulateWorkerCounts(TestRunner& runner)
+{
+    const core::ScheduleTrace t = MakeFanOutTrace();
+
+    core::SimConfig cfg{};
+    cfg.workerCount = 2;
+    const core::SimResult two = core::SimulateSchedule(t, cfg);
+    CHECK(two.totalWorkNs == 45'000'000);
+    CHECK(two.makespanNs == 25'000'000);
+
+    cfg.workerCount = 4;
+    const core::SimResult four = core::SimulateSchedule(t, cfg);
+    CHECK(four.makespanNs == 15'000'000);
+    CHECK(four.utilization > 0.74 && four.utilization < 0.76);
+
+    cfg.workerCount = 1;
+    CHECK(core::SimulateSchedule(t, cfg).makespanNs == 45'000'000);
+
+    // Critical path: one of the fan-out jobs, then the tail.
+    CHECK(four.criticalPathNs == 15'000'000);
+    CHECK(four.criticalPath.size() == 2);
+    if (four.criticalPath.size() == 2)
+        CHECK(four.criticalPath[1] == 5);
+}
+
+static void TestSimulateSpawnedChain(TestRunner& runner)
+{
+    // Parent (10 ms) spawns a child halfway through; the child (10 ms) spawns a grandchild at its start.
+    core::ScheduleTrace t{};
+    t.records.push_back(MakeRecord(1, 0, 0, 0, 0, 10'000'000));
+    t.records.push_back(MakeRecord(2, 1, 0, 5'000'000, 12'000'000, 10'000'000));
+    t.records.push_back(MakeRecord(3, 2, 0, 12'000'000, 30'000'000, 1'000'000));
+
+    core::SimConfig cfg{};
+    cfg.workerCount = 0; // unbounded
+    const core::SimResult r = core::SimulateSchedule(t, cfg);
+    CHECK(r.makespanNs == 15'000'000);
+    CHECK(r.criticalPath == std::vector<uint64_t>({1, 2}));
+
+    cfg.workerCount = 1;
+    CHECK(core::SimulateSchedule(t, cfg).makespanNs == 21'000'000);
+}
+
+static void TestCriticalPathPerFrame(TestRunner& runner)
+{
+    core::ScheduleTrace t = MakeFanOutTrace();
+
+    // Frame 1 gets a second job depending on the tail.
+    core::ScheduleRecord after = MakeRecord(6, 0, 1, 20'000'000, 25'000'000, 3'000'000);
+    after.dependencies = {5};
+    t.records.push_back(after);
+
+    const std::vector<core::CriticalPathReport> reports = core::AnalyzeCriticalPaths(t);
+    CHECK(reports.size() == 2);
+    if (reports.size() != 2)
+        return;
+
+    const core::CriticalPathReport& fanOut = reports[0];
+    CHECK(fanOut.epoch == 0);
+    CHECK(fanOut.jobCount == 4);
+    CHECK(fanOut.totalWorkNs == 40'000'000);
+    CHECK(fanOut.spanNs == 10'000'000);
+    CHECK(fanOut.parallelism > 3.99 && fanOut.parallelism < 4.01);
+    CHECK(fanOut.labels == std::vector<std::string>({"Work"}));
+
+    const core::CriticalPathReport& tail = reports[1];
+    CHECK(tail.epoch == 1);
+    CHECK(tail.spanNs == 8'000'000);
+    CHECK(tail.path == std::vector<uint64_t>({5, 6}));
+    CHECK(tail.labels == std::vector<std::string>({"Tail", ""}));
+}
+
+int main()
+{
+    TestRunner runner;
+
+    TestSaveLoadRoundTrip(runner);
+    TestSimulateWorkerCounts(runner);
+    TestSimulateSpawnedChain(runner);
+    TestCriticalPathPerFrame(runner);
+
+    return runner.Finish();
+}
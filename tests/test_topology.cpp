@@ -0,0 +1,101 @@
+#include "Topology.h"
+#include "TestRunner.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static void WriteFile(const fs::path& path, const std::string& text)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << text << "\n";
+}
+
+// Hybrid part: two SMT P-cores (cpus 0-3) sharing one L3, two E-cores (cpus 4-5) on another,
+// in a cgroup limited to 3 CPUs.
+static fs::path MakeFakeSysfs()
+{
+    const fs::path root = fs::temp_directory_path() / "jobkit_fake_sysfs";
+    fs::remove_all(root);
+
+    const fs::path cpu = root / "devices/system/cpu";
+    WriteFile(cpu / "online", "0-5");
+
+    for (int c = 0; c < 6; ++c)
+    {
+        const fs::path dir = cpu / ("cpu" + std::to_string(c));
+        const bool pcore = c < 4;
+        WriteFile(dir / "topology/thread_siblings_list", pcore ? (c < 2 ? "0-1" : "2-3") : std::to_string(c));
+
+        WriteFile(dir / "cache/index0/level", "1");
+        WriteFile(dir / "cache/index0/shared_cpu_list", pcore ? (c < 2 ? "0-1" : "2-3") : std::to_string(c));
+        WriteFile(dir / "cache/index1/level", "3");
+        WriteFile(dir / "cache/index1/shared_cpu_list", pcore ? "0-3" : "4-5");
+    }
+
+    WriteFile(root / "devices/cpu_atom/cpus", "4-5");
+    WriteFile(root / "devices/system/node/possible", "0");
+    WriteFile(root / "devices/system/node/node0/cpulist", "0-5");
+
+    WriteFile(root / "proc_self_cgroup", "0::/jobs/tool");
+    WriteFile(root / "fs/cgroup/jobs/cpu.max", "300000 100000");
+    WriteFile(root / "fs/cgroup/jobs/tool/cpu.max", "max 100000");
+    return root;
+}
+
+static void TestFakeHybridTopology(TestRunner& runner)
+{
+    const fs::path root = MakeFakeSysfs();
+
+    core::TopologySources src{};
+    src.sysRoot = root.string();
+    src.procSelfCgroup = (root / "proc_self_cgroup").string();
+    src.useAffinityMask = false;
+
+    const core::CpuTopology topo = core::DetectCpuTopology(src);
+    CHECK(topo.cpus.size() == 6);
+    CHECK(topo.physicalCores == 4);
+    CHECK(topo.maxCapacity == 1024);
+    CHECK(topo.cpuQuota > 2.99 && topo.cpuQuota < 3.01);
+
+    if (topo.cpus.size() == 6)
+    {
+        CHECK(topo.cpus[1].core == 0);
+        CHECK(!topo.cpus[1].smtPrimary);
+        CHECK(topo.cpus[2].smtPrimary);
+        CHECK(topo.cpus[3].l3 == 0);
+        CHECK(topo.cpus[5].l3 == 4);
+        CHECK(topo.IsHighCapacity(topo.cpus[0]));
+        CHECK(!topo.IsHighCapacity(topo.cpus[4]));
+    }
+
+    // Four cores, but the quota only buys three.
+    CHECK(core::DefaultWorkerCount(topo) == 3);
+
+    // P-cores, then E-cores, then P-core SMT siblings.
+    CHECK(core::PlanWorkerPlacement(topo, 7) == std::vector<uint32_t>({0, 2, 4, 5, 1, 3, 0}));
+
+    fs::remove_all(root);
+}
+
+static void TestDetectHost(TestRunner& runner)
+{
+    const core::CpuTopology topo = core::DetectCpuTopology();
+    CHECK(!topo.cpus.empty());
+    CHECK(topo.physicalCores >= 1);
+    CHECK(topo.physicalCores <= topo.cpus.size());
+    CHECK(core::DefaultWorkerCount(topo) >= 1);
+    CHECK(core::PlanWorkerPlacement(topo, 2).size() == 2);
+}
+
+int main()
+{
+    TestRunner runner;
+
+    TestFakeHybridTopology(runner);
+    TestDetectHost(runner);
+
+    return runner.Finish();
+}
@@ -0,0 +1,149 @@
+// jobkit_sim: replays a schedule recorded with JobSystem::StartRecording/StopRecording
+// through a discrete-event model of the scheduler for arbitrary worker counts.
+//
+//   jobkit_sim <trace> [--workers N[,N...]] [--policy fifo|lifo] [--frames]
+
+#include "ScheduleTrace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static void PrintUsage()
+{
+    std::fprintf(stderr, "usage: jobkit_sim <trace> [--workers N[,N...]] [--policy fifo|lifo] [--frames]\n");
+}
+
+static bool ParseWorkers(const char* arg, std::vector<uint32_t>& out)
+{
+    const char* p = arg;
+    while (*p)
+    {
+        char* end = nullptr;
+        const unsigned long v = std::strtoul(p, &end, 10);
+        if (end == p || v == 0)
+            return false;
+        if (*end != ',' && *end != '\0')
+            return false;
+        out.push_back((uint32_t)v);
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return !out.empty();
+}
+
+static double Ms(int64_t ns)
+{
+    return (double)ns / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    const char* path = nullptr;
+    std::vector<uint32_t> workerCounts;
+    core::SimPolicy policy = core::SimPolicy::Fifo;
+    bool frames = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+        {
+            if (!ParseWorkers(argv[++i], workerCounts))
+            {
+                PrintUsage();
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--policy") == 0 && i + 1 < argc)
+        {
+            const char* p = argv[++i];
+            if (std::strcmp(p, "fifo") == 0)
+                policy = core::SimPolicy::Fifo;
+            else if (std::strcmp(p, "lifo") == 0)
+                policy = core::SimPolicy::Lifo;
+            else
+            {
+                PrintUsage();
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = true;
+        else if (!path)
+            path = argv[i];
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    core::ScheduleTrace trace;
+    if (!path || !core::LoadScheduleTrace(path, trace))
+    {
+        std::fprintf(stderr, "jobkit_sim: cannot read trace '%s'\n", path ? path : "");
+        return 1;
+    }
+
+    if (workerCounts.empty())
+    {
+        const uint32_t recorded = trace.workerCount ? trace.workerCount : 1;
+        workerCounts = {recorded, recorded * 2};
+    }
+
+    std::printf("trace: %zu jobs, %u workers recorded\n", trace.records.size(), trace.workerCount);
+    std::printf("%8s %14s %12s\n", "workers", "makespan(ms)", "utilization");
+
+    core::SimResult last{};
+    for (uint32_t workers : workerCounts)
+    {
+        core::SimConfig cfg{};
+        cfg.workerCount = workers;
+        cfg.policy = policy;
+
+        last = core::SimulateSchedule(trace, cfg);
+        std::printf("%8u %14.3f %11.1f%%\n", workers, Ms(last.makespanNs), last.utilization * 100.0);
+    }
+
+    std::printf("\ntotal work: %.3f ms, critical path: %.3f ms (%zu jobs)\n",
+        Ms(last.totalWorkNs), Ms(last.criticalPathNs), last.criticalPath.size());
+
+    std::unordered_map<uint64_t, size_t> byId;
+    for (size_t i = 0; i < trace.records.size(); ++i)
+        byId.emplace(trace.records[i].id, i);
+
+    for (uint64_t id : last.criticalPath)
+    {
+        const core::ScheduleRecord& r = trace.records[byId[id]];
+        const std::string& label = trace.labels[r.labelIndex];
+        std::printf("  #%-8llu %10.3f ms  %s\n", (unsigned long long)id, Ms(r.durationNs),
+            label.empty() ? "(unlabeled)" : label.c_str());
+    }
+
+    if (frames)
+    {
+        std::printf("\n%6s %6s %12s %12s %12s  %s\n", "frame", "jobs", "work(ms)", "span(ms)", "parallelism", "critical path");
+        for (const core::CriticalPathReport& rep : core::AnalyzeCriticalPaths(trace))
+        {
+            std::string chain;
+            for (const std::string& label : rep.labels)
+            {
+                if (!chain.empty())
+                    chain += " > ";
+                chain += label.empty() ? "?" : label;
+            }
+            std::printf("%6u %6llu %12.3f %12.3f %12.2f  %s\n", rep.epoch, (unsigned long long)rep.jobCount,
+                Ms(rep.totalWorkNs), Ms(rep.spanNs), rep.parallelism, chain.c_str());
+        }
+    }
+
+    return 0;
+}